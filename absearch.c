@@ -0,0 +1,449 @@
+#include "absearch.h"
+#include "arena.h"
+#include "game.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <time.h>
+#include <errno.h>
+#include <math.h>
+
+#define AB_MAX_PLY 64
+#define AB_INF (1 << 30)
+#define AB_WIN (1 << 24)
+#define AB_TT_BITS 18
+#define AB_NO_MOVE 8
+
+enum { TT_EXACT = 1, TT_LOWER, TT_UPPER };
+
+// Entrada sin lock (Hyatt): check = clave ^ dato, así una escritura a medias
+// de otro hilo se descarta en vez de devolver un dato de otra posición.
+typedef struct {
+    _Atomic uint64_t check;
+    _Atomic uint64_t data;
+} tt_entry_t;
+
+typedef struct {
+    ab_search_t *ab;
+    arena_t arena;
+    int *board;
+    sim_player_t players[MAX_PLAYERS];
+    sim_voronoi_ws_t vor;
+    unsigned int vor_out[MAX_PLAYERS];
+    signed char killers[AB_MAX_PLY][2];
+    int history[MAX_PLAYERS][8];
+    unsigned long nodes;
+    int start_depth;
+    bool main;
+    pthread_t tid;
+    int best_dir;
+    int depth_done;
+    int root_value[8];
+    uint64_t best_ns;
+} ab_worker_t;
+
+struct ab_search {
+    int width;
+    int height;
+    int cells;
+    int player_count;
+    int threads;
+    arena_t tt_arena;
+    tt_entry_t *tt;
+    uint64_t tt_mask;
+    unsigned int generation;
+    const evalnet_t *net;
+    ab_worker_t *workers;
+    int me;
+    int root_free;
+    atomic_bool stop;
+    struct timespec start;
+    int time_ms;
+    unsigned long max_nodes;
+};
+
+static uint64_t elapsed_ns(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - start->tv_sec) * 1000000000ull + (uint64_t)now.tv_nsec - (uint64_t)start->tv_nsec;
+}
+
+// Zobrist sin tablas (splitmix64): con tableros grandes las tablas por celda y
+// jugador ocuparían más que la búsqueda entera.
+static inline uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static inline uint64_t z_taken(int cell, int p) { return mix64((uint64_t)cell << 8 | (uint64_t)p); }
+static inline uint64_t z_at(int cell, int p) { return mix64((uint64_t)cell << 8 | (uint64_t)p | 1ull << 62); }
+static inline uint64_t z_turn(int p) { return mix64((uint64_t)p | 1ull << 63); }
+
+// dato: valor (32) | profundidad (8) | tipo (2) | jugada (4) | generación (8)
+static inline uint64_t tt_pack(int value, int depth, int flag, int move, unsigned int gen) {
+    return (uint64_t)(uint32_t)value | (uint64_t)(depth & 0xFF) << 32 | (uint64_t)flag << 40 |
+           (uint64_t)move << 42 | (uint64_t)(gen & 0xFF) << 46;
+}
+
+static bool tt_probe(ab_search_t *ab, uint64_t key, uint64_t *data) {
+    tt_entry_t *e = &ab->tt[key & ab->tt_mask];
+    uint64_t check = atomic_load_explicit(&e->check, memory_order_relaxed);
+    uint64_t d = atomic_load_explicit(&e->data, memory_order_relaxed);
+    if ((check ^ d) != key || ((d >> 46) & 0xFF) != (ab->generation & 0xFF)) return false;
+    *data = d;
+    return true;
+}
+
+static void tt_store(ab_search_t *ab, uint64_t key, int value, int depth, int flag, int move) {
+    tt_entry_t *e = &ab->tt[key & ab->tt_mask];
+    uint64_t old = atomic_load_explicit(&e->data, memory_order_relaxed);
+    uint64_t old_key = atomic_load_explicit(&e->check, memory_order_relaxed) ^ old;
+    bool same_gen = ((old >> 46) & 0xFF) == (ab->generation & 0xFF);
+    if (same_gen && old_key != key && (int)((old >> 32) & 0xFF) > depth) return;
+    uint64_t d = tt_pack(value, depth, flag, move, ab->generation);
+    atomic_store_explicit(&e->data, d, memory_order_relaxed);
+    atomic_store_explicit(&e->check, key ^ d, memory_order_relaxed);
+}
+
+static void check_limits(ab_worker_t *w) {
+    ab_search_t *ab = w->ab;
+    // La primera iteración se completa siempre para tener una jugada.
+    if (!w->main || w->depth_done < 1) return;
+    if ((ab->max_nodes && w->nodes >= ab->max_nodes) ||
+        (ab->time_ms > 0 && elapsed_ns(&ab->start) >= (uint64_t)ab->time_ms * 1000000ull)) {
+        atomic_store_explicit(&ab->stop, true, memory_order_relaxed);
+    }
+}
+
+static int gen_moves(const ab_worker_t *w, int p, int *moves) {
+    const ab_search_t *ab = w->ab;
+    int n = 0;
+    for (int d = 0; d < 8; d++) {
+        if (sim_is_valid_move(w->board, ab->width, ab->height, (sim_player_t *)w->players, p, d)) moves[n++] = d;
+    }
+    return n;
+}
+
+static int final_diff(const ab_worker_t *w, const unsigned int *extra) {
+    const ab_search_t *ab = w->ab;
+    int me = ab->me;
+    int mine = (int)w->players[me].score + (extra ? (int)extra[me] : 0);
+    int best_opp = ab->player_count > 1 ? INT_MIN : 0;
+    for (int q = 0; q < ab->player_count; q++) {
+        if (q == me) continue;
+        int v = (int)w->players[q].score + (extra ? (int)extra[q] : 0);
+        if (v > best_opp) best_opp = v;
+    }
+    return mine - best_opp;
+}
+
+static int terminal_value(const ab_worker_t *w) {
+    int diff = final_diff(w, NULL);
+    return diff > 0 ? AB_WIN + diff : diff < 0 ? -AB_WIN + diff : 0;
+}
+
+static int evaluate(ab_worker_t *w) {
+    ab_search_t *ab = w->ab;
+    compute_voronoi_potential_buf(w->board, ab->width, ab->height, w->players, ab->player_count, w->vor_out, &w->vor);
+    if (ab->net) {
+        float f[EVALNET_INPUTS];
+        evalnet_features(w->board, ab->width, ab->height, w->players, ab->player_count, ab->me, w->vor_out, f);
+        return (int)lrintf(evalnet_predict(ab->net, f));
+    }
+    return final_diff(w, w->vor_out);
+}
+
+// Ordena: jugada de la tabla, killers del ply, historia y después la recompensa.
+static void order_moves(const ab_worker_t *w, int p, int ply, int tt_move, int *moves, int n) {
+    const ab_search_t *ab = w->ab;
+    int keys[8];
+    int gx = w->players[p].x;
+    int gy = w->players[p].y;
+    for (int i = 0; i < n; i++) {
+        int d = moves[i];
+        int tx, ty;
+        game_target_from_dir(gx, gy, d, &tx, &ty);
+        int k = w->history[p][d] + 16 * w->board[ty * ab->width + tx];
+        if (d == tt_move) k += 1 << 28;
+        else if (ply < AB_MAX_PLY && d == w->killers[ply][0]) k += 1 << 27;
+        else if (ply < AB_MAX_PLY && d == w->killers[ply][1]) k += 1 << 26;
+        keys[i] = k;
+    }
+    for (int i = 1; i < n; i++) {
+        int m = moves[i], k = keys[i], j = i - 1;
+        while (j >= 0 && keys[j] < k) {
+            moves[j + 1] = moves[j];
+            keys[j + 1] = keys[j];
+            j--;
+        }
+        moves[j + 1] = m;
+        keys[j + 1] = k;
+    }
+}
+
+static void note_cutoff(ab_worker_t *w, int p, int ply, int d, int depth) {
+    w->history[p][d] += depth * depth;
+    if (ply < AB_MAX_PLY && w->killers[ply][0] != d) {
+        w->killers[ply][1] = w->killers[ply][0];
+        w->killers[ply][0] = (signed char)d;
+    }
+}
+
+static int search(ab_worker_t *w, int depth, int ply, int p, int alpha, int beta, uint64_t key);
+
+// Aplica d para p, busca al siguiente y deshace.
+static int child(ab_worker_t *w, int depth, int ply, int p, int d, int alpha, int beta, uint64_t key) {
+    ab_search_t *ab = w->ab;
+    sim_player_t saved = w->players[p];
+    int old = saved.y * ab->width + saved.x;
+    int tx, ty;
+    game_target_from_dir(saved.x, saved.y, d, &tx, &ty);
+    int t = ty * ab->width + tx;
+    int reward = w->board[t];
+    sim_apply_move(w->board, ab->width, ab->height, w->players, p, d);
+    int next = (p + 1) % ab->player_count;
+    uint64_t k = key ^ z_taken(t, p) ^ z_at(old, p) ^ z_at(t, p) ^ z_turn(p) ^ z_turn(next);
+    int v = search(w, depth - 1, ply + 1, next, alpha, beta, k);
+    w->board[t] = reward;
+    w->players[p] = saved;
+    return v;
+}
+
+static int search(ab_worker_t *w, int depth, int ply, int p, int alpha, int beta, uint64_t key) {
+    ab_search_t *ab = w->ab;
+    if ((++w->nodes & 1023) == 0) check_limits(w);
+    if (atomic_load_explicit(&ab->stop, memory_order_relaxed)) return 0;
+
+    // Salta a quien no tiene jugadas; queda bloqueado hasta deshacer este nodo.
+    int newly[MAX_PLAYERS];
+    int nb = 0;
+    int moves[8];
+    int n = 0;
+    for (int tries = 0; tries < ab->player_count; tries++) {
+        if (!w->players[p].blocked) {
+            n = gen_moves(w, p, moves);
+            if (n > 0) break;
+            w->players[p].blocked = true;
+            newly[nb++] = p;
+        }
+        int q = (p + 1) % ab->player_count;
+        key ^= z_turn(p) ^ z_turn(q);
+        p = q;
+    }
+
+    int result;
+    if (n == 0) {
+        result = terminal_value(w);
+    } else if (depth <= 0 || ply >= AB_MAX_PLY - 1) {
+        result = evaluate(w);
+    } else {
+        int tt_move = AB_NO_MOVE;
+        uint64_t data;
+        bool hit = tt_probe(ab, key, &data);
+        if (hit) {
+            int tv = (int)(int32_t)(uint32_t)data;
+            int tdepth = (int)((data >> 32) & 0xFF);
+            int flag = (int)((data >> 40) & 0x3);
+            tt_move = (int)((data >> 42) & 0xF);
+            if (tdepth >= depth && (flag == TT_EXACT || (flag == TT_LOWER && tv >= beta) || (flag == TT_UPPER && tv <= alpha))) {
+                for (int i = 0; i < nb; i++) w->players[newly[i]].blocked = false;
+                return tv;
+            }
+        }
+        order_moves(w, p, ply, tt_move, moves, n);
+
+        int alpha0 = alpha, beta0 = beta;
+        bool maximizing = p == ab->me;
+        int best = maximizing ? -AB_INF : AB_INF;
+        int best_move = moves[0];
+        for (int i = 0; i < n; i++) {
+            int v = child(w, depth, ply, p, moves[i], alpha, beta, key);
+            if (atomic_load_explicit(&ab->stop, memory_order_relaxed)) break;
+            if (maximizing ? v > best : v < best) {
+                best = v;
+                best_move = moves[i];
+            }
+            if (maximizing && v > alpha) alpha = v;
+            if (!maximizing && v < beta) beta = v;
+            if (alpha >= beta) {
+                note_cutoff(w, p, ply, moves[i], depth);
+                break;
+            }
+        }
+        result = best;
+        if (!atomic_load_explicit(&ab->stop, memory_order_relaxed)) {
+            int flag = best <= alpha0 ? TT_UPPER : best >= beta0 ? TT_LOWER : TT_EXACT;
+            tt_store(ab, key, best, depth, flag, best_move);
+        }
+    }
+
+    for (int i = 0; i < nb; i++) w->players[newly[i]].blocked = false;
+    return result;
+}
+
+static int root_search(ab_worker_t *w, int depth, uint64_t key, int *best_dir, int *values) {
+    ab_search_t *ab = w->ab;
+    int me = ab->me;
+    int moves[8];
+    int n = gen_moves(w, me, moves);
+    int tt_move = w->best_dir >= 0 ? w->best_dir : AB_NO_MOVE;
+    uint64_t data;
+    if (tt_move == AB_NO_MOVE && tt_probe(ab, key, &data)) tt_move = (int)((data >> 42) & 0xF);
+    order_moves(w, me, 0, tt_move, moves, n);
+
+    int alpha = -AB_INF;
+    int best = -AB_INF;
+    *best_dir = moves[0];
+    for (int i = 0; i < n; i++) {
+        int v = child(w, depth, 0, me, moves[i], alpha, AB_INF, key);
+        if (atomic_load_explicit(&ab->stop, memory_order_relaxed)) break;
+        values[moves[i]] = v;
+        if (v > best) {
+            best = v;
+            *best_dir = moves[i];
+        }
+        if (v > alpha) alpha = v;
+    }
+    if (!atomic_load_explicit(&ab->stop, memory_order_relaxed)) tt_store(ab, key, best, depth, TT_EXACT, *best_dir);
+    return best;
+}
+
+static void iterate(ab_worker_t *w) {
+    ab_search_t *ab = w->ab;
+    uint64_t key = z_turn(ab->me);
+    for (int p = 0; p < ab->player_count; p++) key ^= z_at(w->players[p].y * ab->width + w->players[p].x, p);
+
+    int max_depth = ab->root_free < AB_MAX_PLY - 1 ? ab->root_free : AB_MAX_PLY - 1;
+    for (int depth = w->start_depth; depth <= max_depth; depth++) {
+        int values[8];
+        for (int d = 0; d < 8; d++) values[d] = INT_MIN;
+        int best_dir;
+        int v = root_search(w, depth, key, &best_dir, values);
+        if (atomic_load_explicit(&ab->stop, memory_order_relaxed)) break;
+        if (w->main) {
+            if (best_dir != w->best_dir) w->best_ns = elapsed_ns(&ab->start);
+            w->best_dir = best_dir;
+            w->depth_done = depth;
+            memcpy(w->root_value, values, sizeof(values));
+        }
+        // Resultado final demostrado: más profundidad no cambia nada.
+        if (v >= AB_WIN / 2 || v <= -AB_WIN / 2) break;
+    }
+    if (w->main) atomic_store_explicit(&ab->stop, true, memory_order_relaxed);
+}
+
+static void *helper_main(void *arg) {
+    iterate(arg);
+    return NULL;
+}
+
+ab_search_t *ab_create(int width, int height, int player_count, int threads) {
+    if (width <= 0 || height <= 0 || player_count <= 0 || player_count > MAX_PLAYERS || width > SIM_MAX_SIDE || height > SIM_MAX_SIDE) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (threads < 1) threads = 1;
+    ab_search_t *ab = calloc(1, sizeof(ab_search_t));
+    if (!ab) return NULL;
+    ab->width = width;
+    ab->height = height;
+    ab->cells = width * height;
+    ab->player_count = player_count;
+    ab->threads = threads;
+    ab->workers = calloc((size_t)threads, sizeof(ab_worker_t));
+    size_t tt_bytes = sizeof(tt_entry_t) << AB_TT_BITS;
+    bool huge = getenv("CHOMP_HUGEPAGES") != NULL;
+    if (!ab->workers || arena_init(&ab->tt_arena, tt_bytes, huge) == -1) {
+        ab_destroy(ab);
+        return NULL;
+    }
+    ab->tt = arena_push(&ab->tt_arena, tt_bytes);
+    memset(ab->tt, 0, tt_bytes);
+    ab->tt_mask = (1ull << AB_TT_BITS) - 1;
+
+    size_t cells = (size_t)ab->cells;
+    size_t per_worker = arena_round(sizeof(int) * cells) + arena_round(sizeof(uint16_t) * cells) +
+                        arena_round(sizeof(int8_t) * cells) + arena_round(sizeof(uint32_t) * cells);
+    for (int i = 0; i < threads; i++) {
+        ab_worker_t *w = &ab->workers[i];
+        w->ab = ab;
+        w->main = i == 0;
+        // Lazy SMP: la mitad de los auxiliares arranca un nivel más abajo.
+        w->start_depth = 1 + (i & 1);
+        if (arena_init(&w->arena, per_worker, huge) == -1) {
+            ab_destroy(ab);
+            return NULL;
+        }
+        w->board = arena_push(&w->arena, sizeof(int) * cells);
+        w->vor.dist = arena_push(&w->arena, sizeof(uint16_t) * cells);
+        w->vor.owner = arena_push(&w->arena, sizeof(int8_t) * cells);
+        w->vor.queue = arena_push(&w->arena, sizeof(uint32_t) * cells);
+    }
+    return ab;
+}
+
+void ab_set_eval(ab_search_t *ab, const evalnet_t *net) {
+    ab->net = net;
+}
+
+void ab_destroy(ab_search_t *ab) {
+    if (!ab) return;
+    if (ab->workers) {
+        for (int i = 0; i < ab->threads; i++) arena_destroy(&ab->workers[i].arena);
+        free(ab->workers);
+    }
+    arena_destroy(&ab->tt_arena);
+    free(ab);
+}
+
+int ab_search(ab_search_t *ab, const int *board, const sim_player_t *players, int my_index,
+              int time_ms, unsigned long max_nodes, ab_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->best_dir = -1;
+    for (int d = 0; d < 8; d++) out->value[d] = INT_MIN;
+
+    ab->me = my_index;
+    ab->time_ms = time_ms;
+    ab->max_nodes = max_nodes;
+    ab->generation++;
+    ab->root_free = 0;
+    for (int i = 0; i < ab->cells; i++) {
+        if (board[i] > 0) ab->root_free++;
+    }
+    atomic_store(&ab->stop, false);
+    clock_gettime(CLOCK_MONOTONIC, &ab->start);
+
+    for (int i = 0; i < ab->threads; i++) {
+        ab_worker_t *w = &ab->workers[i];
+        memcpy(w->board, board, sizeof(int) * (size_t)ab->cells);
+        memcpy(w->players, players, sizeof(sim_player_t) * (size_t)ab->player_count);
+        memset(w->killers, -1, sizeof(w->killers));
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            for (int d = 0; d < 8; d++) w->history[p][d] >>= 2;
+        }
+        w->nodes = 0;
+        w->best_dir = -1;
+        w->depth_done = 0;
+        w->best_ns = 0;
+    }
+    ab_worker_t *main_w = &ab->workers[0];
+    int moves[8];
+    if (gen_moves(main_w, my_index, moves) == 0) return -1;
+
+    int started = 1;
+    for (int i = 1; i < ab->threads; i++) {
+        if (pthread_create(&ab->workers[i].tid, NULL, helper_main, &ab->workers[i]) != 0) break;
+        started++;
+    }
+    iterate(main_w);
+    for (int i = 1; i < started; i++) pthread_join(ab->workers[i].tid, NULL);
+
+    out->best_dir = main_w->best_dir;
+    out->depth = main_w->depth_done;
+    out->best_ns = main_w->best_ns;
+    memcpy(out->value, main_w->root_value, sizeof(out->value));
+    for (int i = 0; i < started; i++) out->nodes += ab->workers[i].nodes;
+    return out->best_dir;
+}
@@ -0,0 +1,34 @@
+#ifndef ABSEARCH_H
+#define ABSEARCH_H
+
+#include "sim.h"
+#include "evalnet.h"
+
+// Búsqueda alfa-beta paranoica: el jugador propio maximiza y todos los demás,
+// como coalición, minimizan (score + territorio de Voronoi propio menos el del
+// mejor rival). Profundización iterativa, orden de jugadas con tabla de
+// transposición, killers e historia, y Lazy SMP: con threads > 1 los hilos
+// auxiliares repiten la búsqueda desde otra profundidad y sólo comparten la
+// tabla de transposición.
+typedef struct ab_search ab_search_t;
+
+typedef struct {
+    int best_dir;
+    int depth;             // última iteración completa
+    unsigned long nodes;   // de todos los hilos
+    int value[8];          // por dirección en esa iteración (INT_MIN si no es válida)
+    uint64_t best_ns;      // hasta que best_dir pasó a ser la mejor
+} ab_result_t;
+
+ab_search_t *ab_create(int width, int height, int player_count, int threads);
+void ab_destroy(ab_search_t *ab);
+
+// Con net las hojas se valúan con el evaluador aprendido (NULL: Voronoi crudo).
+void ab_set_eval(ab_search_t *ab, const evalnet_t *net);
+
+// Corta por time_ms o por max_nodes (del hilo principal, así con un solo hilo
+// es determinista); 0 = sin ese límite. Devuelve la dirección o -1 sin jugadas.
+int ab_search(ab_search_t *ab, const int *board, const sim_player_t *players, int my_index,
+              int time_ms, unsigned long max_nodes, ab_result_t *out);
+
+#endif
@@ -0,0 +1,52 @@
+#define _DEFAULT_SOURCE
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE (2u << 20)
+
+int arena_init(arena_t *a, size_t size, bool huge) {
+    memset(a, 0, sizeof(*a));
+    size = arena_round(size ? size : ARENA_ALIGN);
+    if (huge) {
+        size_t len = (size + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            a->huge = true;
+        } else {
+            p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) return -1;
+            a->huge = madvise(p, len, MADV_HUGEPAGE) == 0;
+        }
+        a->base = p;
+        a->size = len;
+        a->mapped = true;
+        return 0;
+    }
+    void *p = NULL;
+    int rc = posix_memalign(&p, ARENA_ALIGN, size);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    a->base = p;
+    a->size = size;
+    return 0;
+}
+
+void arena_destroy(arena_t *a) {
+    if (!a->base) return;
+    if (a->mapped) munmap(a->base, a->size);
+    else free(a->base);
+    memset(a, 0, sizeof(*a));
+}
+
+void *arena_push(arena_t *a, size_t bytes) {
+    size_t need = arena_round(bytes);
+    if (need > a->size - a->used) return NULL;
+    void *p = a->base + a->used;
+    a->used += need;
+    return p;
+}
@@ -0,0 +1,31 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Arena de búsqueda: un solo bloque alineado a 64 bytes (opcionalmente en
+// huge pages) del que se sacan regiones tipadas con arena_push al inicializar
+// la búsqueda. No se libera nada suelto: arena_destroy suelta todo.
+#define ARENA_ALIGN 64
+
+typedef struct {
+    unsigned char *base;
+    size_t size;
+    size_t used;
+    bool mapped;
+    bool huge;
+} arena_t;
+
+// Con huge intenta MAP_HUGETLB y si no hay páginas reservadas cae a
+// madvise(MADV_HUGEPAGE). -1 y errno si no hay memoria.
+int arena_init(arena_t *a, size_t size, bool huge);
+void arena_destroy(arena_t *a);
+
+// Región de bytes redondeada a ARENA_ALIGN; NULL si no entra.
+void *arena_push(arena_t *a, size_t bytes);
+
+// Tamaño que ocupa una región de bytes dentro de la arena.
+static inline size_t arena_round(size_t bytes) { return (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1); }
+
+#endif
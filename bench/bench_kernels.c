@@ -0,0 +1,258 @@
+#include "harness.h"
+#include "../common.h"
+#include "../game.h"
+#include "../strategy.h"
+#include "../shm_manager.h"
+#include "../arena.h"
+#include "../fenwick.h"
+
+#define BENCH_PLAYERS 4
+#define BATCH 4096
+#define HANDSHAKE_ROUNDS 1000
+#define SHM_BENCH_SYNC "/chomp_bench_sync"
+
+typedef struct {
+    int width;
+    int height;
+    int cells;
+    game_state_t *gs;
+    sim_player_t players[BENCH_PLAYERS];
+    sim_player_t players_sim[BENCH_PLAYERS];
+    int *board_sim;
+    unsigned int vor[BENCH_PLAYERS];
+    arena_t arena;
+    sim_voronoi_ws_t vor_ws;
+    fenwick2d_t rewards;
+    unsigned int rng;
+} fixture_t;
+
+static volatile long sink;
+
+static void fixture_init(fixture_t *f, int n) {
+    f->width = n;
+    f->height = n;
+    f->cells = n * n;
+    f->gs = calloc(1, game_state_size(n, n));
+    size_t cells = (size_t)f->cells;
+    size_t bytes = arena_round(sizeof(int) * cells) + arena_round(sizeof(uint16_t) * cells) +
+                   arena_round(sizeof(int8_t) * cells) + arena_round(sizeof(uint32_t) * cells) +
+                   arena_round(fenwick2d_bytes(n, n));
+    if (!f->gs || arena_init(&f->arena, bytes, getenv("CHOMP_HUGEPAGES") != NULL) == -1) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    f->board_sim = arena_push(&f->arena, sizeof(int) * cells);
+    f->vor_ws.dist = arena_push(&f->arena, sizeof(uint16_t) * cells);
+    f->vor_ws.owner = arena_push(&f->arena, sizeof(int8_t) * cells);
+    f->vor_ws.queue = arena_push(&f->arena, sizeof(uint32_t) * cells);
+    fenwick2d_init(&f->rewards, n, n, arena_push(&f->arena, fenwick2d_bytes(n, n)));
+    f->gs->width = n;
+    f->gs->height = n;
+    f->gs->player_count = BENCH_PLAYERS;
+    unsigned int seed = 42;
+    game_init_board_r(f->gs, &seed);
+    game_place_players(f->gs);
+    strategy_players_from_state(f->players, f->gs->players, BENCH_PLAYERS);
+    copy_board(f->board_sim, f->gs->board, f->cells);
+    fenwick2d_build(&f->rewards, f->board_sim);
+    f->rng = 0x12345u;
+}
+
+static void fixture_free(fixture_t *f) {
+    free(f->gs);
+    arena_destroy(&f->arena);
+}
+
+static long run_copy_board(void *arg) {
+    fixture_t *f = arg;
+    copy_board(f->board_sim, f->gs->board, f->cells);
+    return f->cells;
+}
+
+static long run_apply_move(void *arg) {
+    fixture_t *f = arg;
+    long applied = 0;
+    for (int k = 0; k < BATCH; k++) {
+        int p = k % BENCH_PLAYERS;
+        int d = (k / BENCH_PLAYERS) % 8;
+        sim_player_t saved = f->players[p];
+        int tx, ty;
+        game_target_from_dir(saved.x, saved.y, d, &tx, &ty);
+        int idx = (tx >= 0 && tx < f->width && ty >= 0 && ty < f->height) ? ty * f->width + tx : -1;
+        int cell = idx >= 0 ? f->board_sim[idx] : 0;
+        if (sim_apply_move(f->board_sim, f->width, f->height, f->players, p, d) > 0) {
+            f->board_sim[idx] = cell;
+            f->players[p] = saved;
+            applied++;
+        }
+    }
+    sink = applied;
+    return BATCH;
+}
+
+static long run_pick_policy(void *arg) {
+    fixture_t *f = arg;
+    long acc = 0;
+    for (int k = 0; k < BATCH; k++) {
+        acc += sim_pick_policy_move(f->board_sim, f->width, f->height, f->players, BENCH_PLAYERS, k % BENCH_PLAYERS, &f->rng, NULL);
+    }
+    sink = acc;
+    return BATCH;
+}
+
+static long run_playout(void *arg) {
+    fixture_t *f = arg;
+    copy_board(f->board_sim, f->gs->board, f->cells);
+    memcpy(f->players_sim, f->players, sizeof(f->players));
+    long moves = simulate_playout(f->board_sim, f->width, f->height, f->players_sim, BENCH_PLAYERS, 0, &f->rng, NULL);
+    copy_board(f->board_sim, f->gs->board, f->cells);
+    return moves > 0 ? moves : 1;
+}
+
+static long run_voronoi(void *arg) {
+    fixture_t *f = arg;
+    compute_voronoi_potential_buf(f->board_sim, f->width, f->height, f->players, BENCH_PLAYERS, f->vor, &f->vor_ws);
+    sink = f->vor[0];
+    return f->cells;
+}
+
+// Tomar y devolver celdas al azar: dos actualizaciones O(log² n) por iteración.
+static long run_fenwick_add(void *arg) {
+    fixture_t *f = arg;
+    for (int k = 0; k < BATCH; k++) {
+        int idx = (int)(sim_rng_next(&f->rng) % (unsigned int)f->cells);
+        int v = f->board_sim[idx] > 0 ? f->board_sim[idx] : 0;
+        fenwick2d_add(&f->rewards, idx % f->width, idx / f->width, -v);
+        fenwick2d_add(&f->rewards, idx % f->width, idx / f->width, v);
+    }
+    return 2 * BATCH;
+}
+
+#define REGION_RADIUS 4
+
+static long run_fenwick_region(void *arg) {
+    fixture_t *f = arg;
+    long acc = 0;
+    for (int k = 0; k < BATCH; k++) {
+        int idx = (int)(sim_rng_next(&f->rng) % (unsigned int)f->cells);
+        acc += fenwick2d_around(&f->rewards, idx % f->width, idx / f->width, REGION_RADIUS);
+    }
+    sink = acc;
+    return BATCH;
+}
+
+// Referencia: la misma consulta recorriendo las celdas.
+static long run_scan_region(void *arg) {
+    fixture_t *f = arg;
+    long acc = 0;
+    for (int k = 0; k < BATCH; k++) {
+        int idx = (int)(sim_rng_next(&f->rng) % (unsigned int)f->cells);
+        int cx = idx % f->width, cy = idx / f->width;
+        for (int y = cy - REGION_RADIUS; y <= cy + REGION_RADIUS; y++) {
+            if (y < 0 || y >= f->height) continue;
+            for (int x = cx - REGION_RADIUS; x <= cx + REGION_RADIUS; x++) {
+                if (x < 0 || x >= f->width) continue;
+                int v = f->board_sim[y * f->width + x];
+                if (v > 0) acc += v;
+            }
+        }
+    }
+    sink = acc;
+    return BATCH;
+}
+
+static long run_validate(void *arg) {
+    fixture_t *f = arg;
+    long valid = 0;
+    for (int k = 0; k < BATCH; k++) {
+        valid += game_is_valid_move_locked(f->gs, k % BENCH_PLAYERS, (direction_t)((k / BENCH_PLAYERS) % 8));
+    }
+    sink = valid;
+    return BATCH;
+}
+
+typedef struct {
+    game_sync_t *sync;
+    volatile bool *stop;
+} handshake_t;
+
+static long run_handshake(void *arg) {
+    handshake_t *h = arg;
+    for (int i = 0; i < HANDSHAKE_ROUNDS; i++) {
+        sem_post(&h->sync->master_to_view);
+        sem_wait(&h->sync->view_to_master);
+    }
+    return HANDSHAKE_ROUNDS;
+}
+
+// Ida y vuelta master_to_view/view_to_master con un proceso real del otro lado.
+static void bench_handshake(bench_opts_t *opts) {
+    size_t size = sizeof(game_sync_t) + sizeof(bool);
+    shm_manager_t *mgr = shm_manager_create(SHM_BENCH_SYNC, size, 0600, 0, 0);
+    if (!mgr) {
+        perror("shm_manager_create bench sync");
+        return;
+    }
+    game_sync_t *sync = shm_manager_data(mgr);
+    volatile bool *stop = (volatile bool *)(sync + 1);
+    *stop = false;
+    sem_init(&sync->master_to_view, 1, 0);
+    sem_init(&sync->view_to_master, 1, 0);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        shm_manager_destroy(mgr);
+        return;
+    }
+    if (pid == 0) {
+        for (;;) {
+            sem_wait(&sync->master_to_view);
+            if (*stop) _exit(0);
+            sem_post(&sync->view_to_master);
+        }
+    }
+
+    handshake_t h = { sync, stop };
+    bench_run(opts, "sync_handshake", "-", 0, run_handshake, &h);
+
+    *stop = true;
+    sem_post(&sync->master_to_view);
+    waitpid(pid, NULL, 0);
+    sem_destroy(&sync->master_to_view);
+    sem_destroy(&sync->view_to_master);
+    shm_manager_destroy(mgr);
+}
+
+int main(int argc, char *argv[]) {
+    int sizes[16] = { 10, 50, 100, 500, 1000 };
+    int size_count = 5;
+    bench_opts_t opts;
+    bench_parse_args(argc, argv, &opts, sizes, &size_count, 16);
+    bench_print_header(&opts);
+
+    for (int s = 0; s < size_count; s++) {
+        int n = sizes[s];
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", n, n);
+        fixture_t f;
+        fixture_init(&f, n);
+        // Tableros grandes: menos repeticiones para los casos O(celdas).
+        int heavy_reps = n * n > 10000 ? (opts.reps / 10 > 5 ? opts.reps / 10 : 5) : 0;
+
+        if (bench_selected(&opts, "copy_board")) bench_run(&opts, "copy_board", label, 0, run_copy_board, &f);
+        if (bench_selected(&opts, "sim_apply_move")) bench_run(&opts, "sim_apply_move", label, 0, run_apply_move, &f);
+        if (bench_selected(&opts, "sim_pick_policy_move")) bench_run(&opts, "sim_pick_policy_move", label, 0, run_pick_policy, &f);
+        if (bench_selected(&opts, "simulate_playout")) bench_run(&opts, "simulate_playout", label, heavy_reps, run_playout, &f);
+        if (bench_selected(&opts, "compute_voronoi_potential_buf")) bench_run(&opts, "compute_voronoi_potential_buf", label, heavy_reps, run_voronoi, &f);
+        if (bench_selected(&opts, "fenwick_add")) bench_run(&opts, "fenwick_add", label, 0, run_fenwick_add, &f);
+        if (bench_selected(&opts, "fenwick_region")) bench_run(&opts, "fenwick_region", label, 0, run_fenwick_region, &f);
+        if (bench_selected(&opts, "scan_region")) bench_run(&opts, "scan_region", label, 0, run_scan_region, &f);
+        if (bench_selected(&opts, "master_validate")) bench_run(&opts, "master_validate", label, 0, run_validate, &f);
+        fixture_free(&f);
+    }
+    if (bench_selected(&opts, "sync_handshake")) bench_handshake(&opts);
+
+    if (opts.csv != stdout) fclose(opts.csv);
+    return EXIT_SUCCESS;
+}
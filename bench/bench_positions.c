@@ -0,0 +1,146 @@
+#include "../common.h"
+#include "../strategy.h"
+#include "../position.h"
+#include "../metrics.h"
+#include <getopt.h>
+
+// Alimenta un corpus de posiciones (master -P) directo a strategy_decide y
+// reporta latencia, simulaciones/s y coincidencia con la jugada de la partida.
+// Sin -T la búsqueda es determinista (semilla fija por posición), así que
+// sirve como control de regresiones con -G / -A.
+
+typedef struct {
+    int reps;
+    unsigned int seed;
+    strategy_budget_t budget;
+    bool use_budget;
+    bool verbose;
+    double max_p50_ms;
+    double min_agreement;
+} bench_pos_opts_t;
+
+static hist_t latency;
+
+static int run_position(const char *path, const bench_pos_opts_t *o, unsigned long *sims, uint64_t *search_ns,
+                        int *agree, int *comparable, int *stable) {
+    position_t pos;
+    if (position_load(path, &pos) == -1) {
+        perror(path);
+        return -1;
+    }
+    strategy_state_t st = {
+        .width = pos.width,
+        .height = pos.height,
+        .player_count = pos.player_count,
+        .my_index = pos.to_move,
+        .board = pos.board,
+        .players = pos.players
+    };
+
+    hist_t local;
+    memset(&local, 0, sizeof(local));
+    int first_pick = -2;
+    int same = 0;
+    unsigned long pos_sims = 0;
+    for (int r = 0; r < o->reps; r++) {
+        strategy_t *s = strategy_create(pos.width, pos.height, pos.player_count, o->seed + (unsigned int)r);
+        if (!s) {
+            perror("strategy_create");
+            position_free(&pos);
+            return -1;
+        }
+        uint64_t t0 = metrics_now_ns();
+        int pick = strategy_decide(s, &st, o->use_budget ? &o->budget : NULL);
+        uint64_t dt = metrics_now_ns() - t0;
+        hist_record(&latency, dt);
+        hist_record(&local, dt);
+        *search_ns += dt;
+        pos_sims += strategy_last_stats(s)->sims;
+        if (r == 0) first_pick = pick;
+        if (pick == first_pick) same++;
+        if (pos.played >= 0) {
+            (*comparable)++;
+            if (pick == pos.played) (*agree)++;
+        }
+        strategy_destroy(s);
+    }
+    *sims += pos_sims;
+    *stable += same;
+    if (o->verbose) {
+        printf("%s,%dx%d,%.3f,%.3f,%lu,%d,%d\n", path, pos.width, pos.height,
+               hist_percentile(&local, 0.50) / 1e6, local.max / 1e6, pos_sims / (unsigned long)o->reps,
+               first_pick, pos.played);
+    }
+    position_free(&pos);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    bench_pos_opts_t o = { .reps = 3, .seed = 12345, .max_p50_ms = 0, .min_agreement = -1 };
+    int opt;
+    while ((opt = getopt(argc, argv, "r:S:T:s:G:A:v")) != -1) {
+        switch (opt) {
+            case 'r': o.reps = atoi(optarg); break;
+            case 'S': o.budget.max_sims = atoi(optarg); o.use_budget = true; break;
+            case 'T': o.budget.time_ms = atoi(optarg); o.use_budget = true; break;
+            case 's': o.seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'G': o.max_p50_ms = atof(optarg); break;
+            case 'A': o.min_agreement = atof(optarg); break;
+            case 'v': o.verbose = true; break;
+            default:
+                fprintf(stderr, "Uso: %s [-r reps] [-S max_sims] [-T time_ms] [-s seed] [-G max_p50_ms] [-A min_coincidencia_%%] [-v] corpus_dir|archivo.pos ...\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (o.reps < 1) o.reps = 1;
+    if (optind >= argc) {
+        fprintf(stderr, "Falta el corpus (directorio con *.pos o archivos)\n");
+        return EXIT_FAILURE;
+    }
+
+    char **paths = NULL;
+    int count = 0;
+    for (int i = optind; i < argc; i++) {
+        int n = position_collect(argv[i], &paths, count);
+        if (n == -1) {
+            perror(argv[i]);
+            position_free_paths(paths, count);
+            return EXIT_FAILURE;
+        }
+        count = n;
+    }
+    if (count == 0) {
+        fprintf(stderr, "El corpus no tiene posiciones\n");
+        return EXIT_FAILURE;
+    }
+
+    if (o.verbose) printf("position,size,p50_ms,max_ms,sims,pick,played\n");
+    unsigned long sims = 0;
+    uint64_t search_ns = 0;
+    int agree = 0, comparable = 0, stable = 0, loaded = 0;
+    for (int i = 0; i < count; i++) {
+        if (run_position(paths[i], &o, &sims, &search_ns, &agree, &comparable, &stable) == 0) loaded++;
+    }
+    position_free_paths(paths, count);
+    if (loaded == 0) return EXIT_FAILURE;
+
+    double p50_ms = hist_percentile(&latency, 0.50) / 1e6;
+    double agreement = comparable ? 100.0 * agree / comparable : -1.0;
+    printf("posiciones=%d decisiones=%llu p50_ms=%.3f p90_ms=%.3f p99_ms=%.3f max_ms=%.3f sims_s=%.0f",
+           loaded, (unsigned long long)latency.count, p50_ms, hist_percentile(&latency, 0.90) / 1e6,
+           hist_percentile(&latency, 0.99) / 1e6, latency.max / 1e6,
+           search_ns ? sims * 1e9 / (double)search_ns : 0.0);
+    if (agreement >= 0) printf(" coincidencia=%.1f%%", agreement);
+    printf(" estabilidad=%.1f%%\n", 100.0 * stable / (double)latency.count);
+
+    int rc = EXIT_SUCCESS;
+    if (o.max_p50_ms > 0 && p50_ms > o.max_p50_ms) {
+        fprintf(stderr, "regresión: p50 %.3f ms > %.3f ms\n", p50_ms, o.max_p50_ms);
+        rc = EXIT_FAILURE;
+    }
+    if (o.min_agreement >= 0 && agreement >= 0 && agreement < o.min_agreement) {
+        fprintf(stderr, "regresión: coincidencia %.1f%% < %.1f%%\n", agreement, o.min_agreement);
+        rc = EXIT_FAILURE;
+    }
+    return rc;
+}
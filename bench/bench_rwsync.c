@@ -0,0 +1,354 @@
+#define _DEFAULT_SOURCE
+#include "../common.h"
+#include "../rwsync.h"
+#include "../metrics.h"
+#include "../shm_manager.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+// Estrés del protocolo lectores-escritor: 1 escritor (el master) y N lectores
+// (los jugadores) sobre memoria compartida real, comparando variantes:
+//   sem     el protocolo actual (game_sync_t + rwsync.h, escritor master_mutex+state_mutex)
+//   futex   rwlock de una palabra con preferencia de escritor
+//   seqlock el escritor nunca espera; los lectores reintentan si hubo escritura
+// Una fila CSV por (variante, lectores) para graficarlas juntas.
+
+#define SHM_BENCH_RW "/chomp_bench_rw"
+
+#define FRW_HELD    0x80000000u
+#define FRW_WAITING 0x40000000u
+#define FRW_READERS 0x3fffffffu
+
+typedef enum { VARIANT_SEM, VARIANT_FUTEX, VARIANT_SEQLOCK, VARIANT_COUNT } variant_t;
+static const char *const variant_names[VARIANT_COUNT] = { "sem", "futex", "seqlock" };
+
+typedef struct {
+    uint64_t ops;
+    uint64_t retries;
+    uint64_t torn;
+    hist_t wait;
+} rw_stats_t;
+
+typedef struct {
+    game_sync_t sync;
+    _Atomic uint32_t frw;
+    _Atomic uint32_t seq;
+    _Atomic int start;
+    _Atomic int stop;
+    rw_stats_t writer;
+    rw_stats_t readers[MAX_PLAYERS_PROBE];
+    _Atomic int payload[];
+} rw_shared_t;
+
+typedef struct {
+    int duration_ms;
+    int payload_cells;
+    int writer_pause_us;
+    int reader_pause_us;
+} rw_opts_t;
+
+static void futex_wait(_Atomic uint32_t *addr, uint32_t val) {
+    syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+static void futex_wake_all(_Atomic uint32_t *addr) {
+    syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static void frw_read_lock(_Atomic uint32_t *w) {
+    for (;;) {
+        uint32_t s = atomic_load_explicit(w, memory_order_relaxed);
+        if (s & (FRW_HELD | FRW_WAITING)) {
+            futex_wait(w, s);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(w, &s, s + 1, memory_order_acquire, memory_order_relaxed)) return;
+    }
+}
+
+static void frw_read_unlock(_Atomic uint32_t *w) {
+    uint32_t s = atomic_fetch_sub_explicit(w, 1, memory_order_release) - 1;
+    if ((s & FRW_READERS) == 0 && (s & FRW_WAITING)) futex_wake_all(w);
+}
+
+static void frw_write_lock(_Atomic uint32_t *w) {
+    for (;;) {
+        uint32_t s = atomic_load_explicit(w, memory_order_relaxed);
+        if ((s & (FRW_READERS | FRW_HELD)) == 0) {
+            if (atomic_compare_exchange_weak_explicit(w, &s, (s | FRW_HELD) & ~FRW_WAITING,
+                                                      memory_order_acquire, memory_order_relaxed)) return;
+            continue;
+        }
+        if (!(s & FRW_WAITING)) {
+            atomic_compare_exchange_weak_explicit(w, &s, s | FRW_WAITING, memory_order_relaxed, memory_order_relaxed);
+            continue;
+        }
+        futex_wait(w, s);
+    }
+}
+
+static void frw_write_unlock(_Atomic uint32_t *w) {
+    atomic_fetch_and_explicit(w, ~FRW_HELD, memory_order_release);
+    futex_wake_all(w);
+}
+
+static void write_payload(rw_shared_t *sh, int cells, int value) {
+    for (int i = 0; i < cells; i++) atomic_store_explicit(&sh->payload[i], value, memory_order_relaxed);
+}
+
+// Devuelve true si todas las celdas tienen el mismo valor (lectura no rota).
+static bool read_payload(rw_shared_t *sh, int cells) {
+    int first = atomic_load_explicit(&sh->payload[0], memory_order_relaxed);
+    bool ok = true;
+    for (int i = 1; i < cells; i++) {
+        if (atomic_load_explicit(&sh->payload[i], memory_order_relaxed) != first) ok = false;
+    }
+    return ok;
+}
+
+static void pause_us(int us) {
+    if (us <= 0) return;
+    struct timespec ts = { us / 1000000, (long)(us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static void wait_start(rw_shared_t *sh) {
+    while (!atomic_load(&sh->start)) sched_yield();
+}
+
+static void run_writer(rw_shared_t *sh, variant_t v, const rw_opts_t *o) {
+    rw_stats_t *st = &sh->writer;
+    int value = 0;
+    wait_start(sh);
+    while (!atomic_load_explicit(&sh->stop, memory_order_relaxed)) {
+        uint64_t t0 = metrics_now_ns();
+        value++;
+        switch (v) {
+            case VARIANT_SEM:
+                sem_wait(&sh->sync.master_mutex);
+                sem_wait(&sh->sync.state_mutex);
+                hist_record(&st->wait, metrics_now_ns() - t0);
+                write_payload(sh, o->payload_cells, value);
+                sem_post(&sh->sync.state_mutex);
+                sem_post(&sh->sync.master_mutex);
+                break;
+            case VARIANT_FUTEX:
+                frw_write_lock(&sh->frw);
+                hist_record(&st->wait, metrics_now_ns() - t0);
+                write_payload(sh, o->payload_cells, value);
+                frw_write_unlock(&sh->frw);
+                break;
+            case VARIANT_SEQLOCK:
+                hist_record(&st->wait, metrics_now_ns() - t0);
+                atomic_fetch_add_explicit(&sh->seq, 1, memory_order_relaxed);
+                atomic_thread_fence(memory_order_release);
+                write_payload(sh, o->payload_cells, value);
+                atomic_fetch_add_explicit(&sh->seq, 1, memory_order_release);
+                break;
+            default:
+                break;
+        }
+        st->ops++;
+        pause_us(o->writer_pause_us);
+    }
+}
+
+static void run_reader(rw_shared_t *sh, int id, variant_t v, const rw_opts_t *o) {
+    rw_stats_t *st = &sh->readers[id];
+    wait_start(sh);
+    while (!atomic_load_explicit(&sh->stop, memory_order_relaxed)) {
+        uint64_t t0 = metrics_now_ns();
+        bool ok;
+        switch (v) {
+            case VARIANT_SEM:
+                reader_enter(&sh->sync);
+                hist_record(&st->wait, metrics_now_ns() - t0);
+                ok = read_payload(sh, o->payload_cells);
+                reader_exit(&sh->sync);
+                break;
+            case VARIANT_FUTEX:
+                frw_read_lock(&sh->frw);
+                hist_record(&st->wait, metrics_now_ns() - t0);
+                ok = read_payload(sh, o->payload_cells);
+                frw_read_unlock(&sh->frw);
+                break;
+            case VARIANT_SEQLOCK: {
+                uint32_t s1, s2;
+                int spins = 0;
+                for (;;) {
+                    s1 = atomic_load_explicit(&sh->seq, memory_order_acquire);
+                    if (s1 & 1) {
+                        // Con pocos CPUs el escritor puede estar desalojado a mitad de escritura.
+                        if (++spins > 64) sched_yield();
+                        continue;
+                    }
+                    ok = read_payload(sh, o->payload_cells);
+                    atomic_thread_fence(memory_order_acquire);
+                    s2 = atomic_load_explicit(&sh->seq, memory_order_relaxed);
+                    if (s1 == s2) break;
+                    st->retries++;
+                }
+                hist_record(&st->wait, metrics_now_ns() - t0);
+                break;
+            }
+            default:
+                ok = true;
+                break;
+        }
+        if (!ok) st->torn++;
+        st->ops++;
+        pause_us(o->reader_pause_us);
+    }
+}
+
+static void hist_merge(hist_t *dst, const hist_t *src) {
+    if (!src->count) return;
+    if (dst->count == 0 || src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    dst->count += src->count;
+    dst->sum += src->sum;
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->buckets[i] += src->buckets[i];
+}
+
+static int run_case(rw_shared_t *sh, variant_t v, int readers, const rw_opts_t *o, FILE *csv) {
+    memset(&sh->writer, 0, sizeof(sh->writer));
+    memset(sh->readers, 0, sizeof(sh->readers));
+    atomic_store(&sh->frw, 0);
+    atomic_store(&sh->seq, 0);
+    atomic_store(&sh->start, 0);
+    atomic_store(&sh->stop, 0);
+    sh->sync.reader_count = 0;
+    write_payload(sh, o->payload_cells, 0);
+
+    pid_t pids[MAX_PLAYERS_PROBE + 1];
+    int spawned = 0;
+    for (int i = 0; i <= readers; i++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork");
+            break;
+        }
+        if (pid == 0) {
+            if (i == 0) run_writer(sh, v, o);
+            else run_reader(sh, i - 1, v, o);
+            _exit(0);
+        }
+        pids[spawned++] = pid;
+    }
+    if (spawned == readers + 1) {
+        uint64_t t0 = metrics_now_ns();
+        atomic_store(&sh->start, 1);
+        pause_us(o->duration_ms * 1000);
+        atomic_store(&sh->stop, 1);
+        for (int i = 0; i < spawned; i++) waitpid(pids[i], NULL, 0);
+        double secs = (double)(metrics_now_ns() - t0) / 1e9;
+
+        static hist_t reader_wait;
+        memset(&reader_wait, 0, sizeof(reader_wait));
+        uint64_t reads = 0, retries = 0, torn = sh->writer.torn, min_reads = UINT64_MAX, max_reads = 0;
+        int starved = 0;
+        for (int i = 0; i < readers; i++) {
+            rw_stats_t *r = &sh->readers[i];
+            reads += r->ops;
+            retries += r->retries;
+            torn += r->torn;
+            if (r->ops < min_reads) min_reads = r->ops;
+            if (r->ops > max_reads) max_reads = r->ops;
+            if (r->ops == 0) starved++;
+            hist_merge(&reader_wait, &r->wait);
+        }
+        const hist_t *ww = &sh->writer.wait;
+        fprintf(csv, "%s,%d,%.3f,%llu,%llu,%llu,%llu,%llu,%.0f,%llu,%llu,%llu,%d,%llu,%llu\n",
+                variant_names[v], readers, secs, (unsigned long long)sh->writer.ops,
+                (unsigned long long)hist_percentile(ww, 0.50), (unsigned long long)hist_percentile(ww, 0.99),
+                (unsigned long long)ww->max, (unsigned long long)reads, reads / secs,
+                (unsigned long long)hist_percentile(&reader_wait, 0.99),
+                (unsigned long long)(readers ? min_reads : 0), (unsigned long long)max_reads, starved,
+                (unsigned long long)retries, (unsigned long long)torn);
+        fflush(csv);
+        return 0;
+    }
+    atomic_store(&sh->stop, 1);
+    atomic_store(&sh->start, 1);
+    for (int i = 0; i < spawned; i++) waitpid(pids[i], NULL, 0);
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    rw_opts_t o = { .duration_ms = 500, .payload_cells = 100 * 100, .writer_pause_us = 50, .reader_pause_us = 0 };
+    int counts[32] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    int count_n = 8;
+    bool enabled[VARIANT_COUNT] = { true, true, true };
+    FILE *csv = stdout;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:v:d:b:p:q:o:")) != -1) {
+        switch (opt) {
+            case 'n': {
+                count_n = 0;
+                char *save = NULL;
+                for (char *tok = strtok_r(optarg, ",", &save); tok && count_n < 32; tok = strtok_r(NULL, ",", &save)) {
+                    int v = atoi(tok);
+                    if (v >= 1 && v <= MAX_PLAYERS_PROBE) counts[count_n++] = v;
+                }
+                break;
+            }
+            case 'v':
+                for (int i = 0; i < VARIANT_COUNT; i++) enabled[i] = strstr(optarg, variant_names[i]) != NULL;
+                break;
+            case 'd': o.duration_ms = atoi(optarg); break;
+            case 'b': o.payload_cells = atoi(optarg); break;
+            case 'p': o.writer_pause_us = atoi(optarg); break;
+            case 'q': o.reader_pause_us = atoi(optarg); break;
+            case 'o':
+                csv = fopen(optarg, "w");
+                if (!csv) {
+                    perror(optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                fprintf(stderr, "Uso: %s [-n 1,8,128] [-v sem,futex,seqlock] [-d ms] [-b celdas] [-p pausa_escritor_us] [-q pausa_lector_us] [-o salida.csv]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (o.payload_cells < 1) o.payload_cells = 1;
+
+    size_t size = sizeof(rw_shared_t) + sizeof(_Atomic int) * (size_t)o.payload_cells;
+    shm_manager_t *mgr = shm_manager_create(SHM_BENCH_RW, size, 0600, 0, 0);
+    if (!mgr) {
+        perror("shm_manager_create bench rw");
+        return EXIT_FAILURE;
+    }
+    rw_shared_t *sh = shm_manager_data(mgr);
+    if (sem_init(&sh->sync.master_mutex, 1, 1) == -1 || sem_init(&sh->sync.state_mutex, 1, 1) == -1 ||
+        sem_init(&sh->sync.reader_count_mutex, 1, 1) == -1) {
+        perror("sem_init");
+        shm_manager_destroy(mgr);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(csv, "variant,readers,seconds,writes,writer_wait_p50_ns,writer_wait_p99_ns,writer_wait_max_ns,"
+                 "reads,reads_per_s,reader_wait_p99_ns,reader_min_reads,reader_max_reads,starved_readers,retries,torn\n");
+    int rc = EXIT_SUCCESS;
+    for (int c = 0; c < count_n && rc == EXIT_SUCCESS; c++) {
+        for (int v = 0; v < VARIANT_COUNT; v++) {
+            if (!enabled[v]) continue;
+            if (run_case(sh, (variant_t)v, counts[c], &o, csv) == -1) {
+                rc = EXIT_FAILURE;
+                break;
+            }
+        }
+    }
+
+    sem_destroy(&sh->sync.master_mutex);
+    sem_destroy(&sh->sync.state_mutex);
+    sem_destroy(&sh->sync.reader_count_mutex);
+    shm_manager_destroy(mgr);
+    if (csv != stdout) fclose(csv);
+    return rc;
+}
@@ -0,0 +1,52 @@
+#!/bin/sh
+# Mide jugadas/s y latencia por jugada del master a -d 0 contra N player_flood.
+# Uso: bench/flood.sh [-w ancho] [-h alto] [-n "1 2 4 9"] [-i ratio_invalidas] [-r repeticiones] [-R hilos_arbitro]
+# Salida CSV por stdout.
+
+set -e
+cd "$(dirname "$0")/.."
+
+W=200
+H=200
+COUNTS="1 2 4 9"
+INVALID=0
+REPS=3
+REFEREE=0
+while getopts "w:h:n:i:r:R:" opt; do
+    case $opt in
+        w) W=$OPTARG ;;
+        h) H=$OPTARG ;;
+        n) COUNTS=$OPTARG ;;
+        i) INVALID=$OPTARG ;;
+        r) REPS=$OPTARG ;;
+        R) REFEREE=$OPTARG ;;
+        *) sed -n 3p "$0" >&2; exit 1 ;;
+    esac
+done
+
+[ -x ./master ] && [ -x ./player_flood ] || { echo "falta ./master o ./player_flood (correr make)" >&2; exit 1; }
+
+metrics=$(mktemp)
+trap 'rm -f "$metrics"' EXIT
+
+echo "players,invalid_ratio,rep,moves,seconds,moves_per_s,ready_to_apply_p50_us,ready_to_apply_p99_us,move_interval_p99_us"
+for n in $COUNTS; do
+    players=""
+    i=0
+    while [ $i -lt "$n" ]; do players="$players ./player_flood"; i=$((i + 1)); done
+    rep=1
+    while [ "$rep" -le "$REPS" ]; do
+        t0=$(date +%s%N)
+        # shellcheck disable=SC2086
+        CHOMP_FLOOD_INVALID=$INVALID ./master -d 0 -t 1 -R "$REFEREE" -w "$W" -h "$H" -s "$rep" -m $players >/dev/null 2>"$metrics"
+        t1=$(date +%s%N)
+        awk -v n="$n" -v inv="$INVALID" -v rep="$rep" -v ns=$((t1 - t0)) '
+            $1 == "ready_to_apply" { moves = $2; p50 = $4; p99 = $6 }
+            $1 ~ /^move_interval/ && $6 > mi { mi = $6 }
+            END {
+                s = ns / 1e9
+                printf "%d,%s,%d,%d,%.3f,%.0f,%s,%s,%s\n", n, inv, rep, moves, s, moves / s, p50, p99, mi + 0
+            }' "$metrics"
+        rep=$((rep + 1))
+    done
+done
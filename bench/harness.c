@@ -0,0 +1,136 @@
+#include "harness.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include "../sim.h"
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+void bench_parse_args(int argc, char *argv[], bench_opts_t *opts, int *sizes, int *size_count, int max_sizes) {
+    opts->warmup = 3;
+    opts->reps = 51;
+    opts->filter = NULL;
+    opts->csv = stdout;
+    bool counters = true;
+    static const struct option long_opts[] = {
+        { "kernel", required_argument, NULL, 'K' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "w:r:k:s:o:n", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'w': opts->warmup = atoi(optarg); break;
+            case 'r': opts->reps = atoi(optarg); break;
+            case 'k': opts->filter = optarg; break;
+            case 's': {
+                *size_count = 0;
+                char *save = NULL;
+                for (char *tok = strtok_r(optarg, ",", &save); tok && *size_count < max_sizes; tok = strtok_r(NULL, ",", &save)) {
+                    int v = atoi(tok);
+                    if (v > 0) sizes[(*size_count)++] = v;
+                }
+                break;
+            }
+            case 'o':
+                opts->csv = fopen(optarg, "w");
+                if (!opts->csv) {
+                    perror(optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'n': counters = false; break;
+            case 'K':
+                if (sim_kernel_select(optarg) == -1) {
+                    fprintf(stderr, "bench: núcleos %s no disponibles en esta CPU\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            default:
+                fprintf(stderr, "Uso: %s [-w warmup] [-r reps] [-k kernel] [-s 10,100,1000] [-o salida.csv] [-n] [--kernel=auto|scalar|sse4.2|avx2|avx512]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (opts->reps < 1) opts->reps = 1;
+    if (opts->warmup < 0) opts->warmup = 0;
+    memset(&opts->counters, 0, sizeof(opts->counters));
+    fprintf(stderr, "bench: núcleos %s\n", sim_kernels()->name);
+    if (counters && perfctr_open(&opts->counters) == 0) {
+        fprintf(stderr, "bench: contadores de hardware no disponibles, sólo se mide tiempo\n");
+    }
+}
+
+bool bench_selected(const bench_opts_t *opts, const char *kernel) {
+    return opts->filter == NULL || strstr(kernel, opts->filter) != NULL;
+}
+
+void bench_print_header(const bench_opts_t *opts) {
+    fprintf(opts->csv, "kernel,size,reps,ops_per_call,min_ns,median_ns,p99_ns,mean_ns,ns_per_op");
+    for (int i = 0; i < PERFCTR_COUNT; i++) fprintf(opts->csv, ",%s_per_op", perfctr_names[i]);
+    fprintf(opts->csv, ",ipc\n");
+    fflush(opts->csv);
+}
+
+bench_result_t bench_run(bench_opts_t *opts, const char *kernel, const char *size, int reps, bench_fn fn, void *arg) {
+    bench_result_t r;
+    memset(&r, 0, sizeof(r));
+    if (reps <= 0) reps = opts->reps;
+
+    for (int i = 0; i < opts->warmup; i++) fn(arg);
+
+    double *samples = malloc(sizeof(double) * reps);
+    if (!samples) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    perfctr_t *pc = &opts->counters;
+    perfctr_reset(pc);
+    long total_ops = 0;
+    double sum = 0.0;
+    for (int i = 0; i < reps; i++) {
+        uint64_t t0 = bench_now_ns();
+        perfctr_resume(pc);
+        long ops = fn(arg);
+        perfctr_pause(pc);
+        uint64_t t1 = bench_now_ns();
+        samples[i] = (double)(t1 - t0);
+        sum += samples[i];
+        total_ops += ops;
+    }
+    qsort(samples, reps, sizeof(double), cmp_double);
+
+    int p99 = (int)(0.99 * (reps - 1) + 0.5);
+    r.min_ns = samples[0];
+    r.median_ns = samples[reps / 2];
+    r.p99_ns = samples[p99];
+    r.mean_ns = sum / reps;
+    r.ops = total_ops / reps;
+    r.ns_per_op = total_ops > 0 ? sum / (double)total_ops : 0.0;
+    free(samples);
+
+    perfctr_read(pc);
+    fprintf(opts->csv, "%s,%s,%d,%ld,%.0f,%.0f,%.0f,%.0f,%.2f",
+            kernel, size, reps, r.ops, r.min_ns, r.median_ns, r.p99_ns, r.mean_ns, r.ns_per_op);
+    for (int i = 0; i < PERFCTR_COUNT; i++) {
+        r.per_op[i] = pc->valid[i] && total_ops > 0 ? (double)pc->values[i] / (double)total_ops : -1.0;
+        if (r.per_op[i] >= 0) fprintf(opts->csv, ",%.3f", r.per_op[i]);
+        else fprintf(opts->csv, ",");
+    }
+    if (r.per_op[PERFCTR_CYCLES] > 0 && r.per_op[PERFCTR_INSTRUCTIONS] >= 0) {
+        fprintf(opts->csv, ",%.2f\n", r.per_op[PERFCTR_INSTRUCTIONS] / r.per_op[PERFCTR_CYCLES]);
+    } else {
+        fprintf(opts->csv, ",\n");
+    }
+    fflush(opts->csv);
+    return r;
+}
@@ -0,0 +1,41 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../perfctr.h"
+
+// Harness mínimo: calentamiento, repeticiones cronometradas y una fila CSV por
+// caso con min/mediana/p99/media por llamada y ns por operación. Si hay
+// contadores de hardware, agrega ciclos/instrucciones/fallos por operación.
+typedef struct {
+    int warmup;
+    int reps;
+    const char *filter;
+    FILE *csv;
+    perfctr_t counters;
+} bench_opts_t;
+
+// Una llamada al caso; devuelve cuántas operaciones realizó (para ns/op).
+typedef long (*bench_fn)(void *arg);
+
+typedef struct {
+    double min_ns;
+    double median_ns;
+    double p99_ns;
+    double mean_ns;
+    double ns_per_op;
+    long ops;
+    double per_op[PERFCTR_COUNT];  // < 0 si el contador no está disponible
+
+} bench_result_t;
+
+void bench_parse_args(int argc, char *argv[], bench_opts_t *opts, int *sizes, int *size_count, int max_sizes);
+bool bench_selected(const bench_opts_t *opts, const char *kernel);
+void bench_print_header(const bench_opts_t *opts);
+bench_result_t bench_run(bench_opts_t *opts, const char *kernel, const char *size, int reps, bench_fn fn, void *arg);
+
+uint64_t bench_now_ns(void);
+
+#endif
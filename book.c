@@ -0,0 +1,205 @@
+#include "book.h"
+#include "game.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BOOK_MAGIC "CBK1"
+
+struct book {
+    void *map;
+    size_t len;
+    const book_entry_t *slots;
+    uint64_t mask;
+    uint64_t entries;
+};
+
+static const int sym_dx[8][2] = { {1, 0}, {-1, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {0, 1}, {0, -1} };
+static const int sym_dy[8][2] = { {0, 1}, {0, 1}, {0, -1}, {0, -1}, {1, 0}, {1, 0}, {-1, 0}, {-1, 0} };
+static const int dir_dx[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int dir_dy[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+static inline uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Simetrías: 0 identidad, 1 espejo en x, 2 espejo en y, 3 giro de 180; con
+// tablero cuadrado además 4 transpuesta, 5 giro de 90, 6 giro de 270 y 7
+// antitranspuesta. sym_dx/sym_dy son la parte lineal: (dx, dy) -> (dx', dy').
+static inline void sym_point(int t, int w, int h, int x, int y, int *ox, int *oy) {
+    switch (t) {
+        case 0: *ox = x;         *oy = y;         break;
+        case 1: *ox = w - 1 - x; *oy = y;         break;
+        case 2: *ox = x;         *oy = h - 1 - y; break;
+        case 3: *ox = w - 1 - x; *oy = h - 1 - y; break;
+        case 4: *ox = y;         *oy = x;         break;
+        case 5: *ox = h - 1 - y; *oy = x;         break;
+        case 6: *ox = y;         *oy = w - 1 - x; break;
+        default: *ox = h - 1 - y; *oy = w - 1 - x; break;
+    }
+}
+
+static int sym_dir(int t, int d) {
+    int dx = dir_dx[d], dy = dir_dy[d];
+    int nx = sym_dx[t][0] * dx + sym_dx[t][1] * dy;
+    int ny = sym_dy[t][0] * dx + sym_dy[t][1] * dy;
+    for (int k = 0; k < 8; k++) {
+        if (dir_dx[k] == nx && dir_dy[k] == ny) return k;
+    }
+    return -1;
+}
+
+uint64_t book_key(const int *board, int width, int height, const sim_player_t *players, int player_count, int me, int *sym) {
+    int nsym = width == height ? 8 : 4;
+    uint64_t h[8];
+    uint64_t base = mix64((uint64_t)width << 40 | (uint64_t)height << 16 | (uint64_t)player_count << 8 | (uint64_t)me);
+    for (int t = 0; t < nsym; t++) h[t] = base;
+    // Suma de términos por celda: no depende del orden de recorrido, así las
+    // 8 simetrías salen de una sola pasada sobre el tablero.
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint64_t v = (uint64_t)(uint8_t)board[y * width + x];
+            for (int t = 0; t < nsym; t++) {
+                int tx, ty;
+                sym_point(t, width, height, x, y, &tx, &ty);
+                h[t] += mix64((uint64_t)(ty * width + tx) << 8 | v);
+            }
+        }
+    }
+    for (int p = 0; p < player_count; p++) {
+        uint64_t extra = (uint64_t)players[p].score << 8 | (uint64_t)players[p].blocked << 4 | (uint64_t)p;
+        for (int t = 0; t < nsym; t++) {
+            int tx, ty;
+            sym_point(t, width, height, players[p].x, players[p].y, &tx, &ty);
+            h[t] += mix64(mix64((uint64_t)(ty * width + tx) | 1ull << 63) ^ extra);
+        }
+    }
+    int best = 0;
+    for (int t = 1; t < nsym; t++) {
+        if (h[t] < h[best]) best = t;
+    }
+    if (sym) *sym = best;
+    return h[best] ? h[best] : 1;
+}
+
+book_t *book_open(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t)st.st_size;
+    if (len < sizeof(book_header_t)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+    void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    const book_header_t *hdr = map;
+    if (memcmp(hdr->magic, BOOK_MAGIC, 4) != 0 || hdr->slot_bits > 40 ||
+        len != sizeof(book_header_t) + (sizeof(book_entry_t) << hdr->slot_bits)) {
+        munmap(map, len);
+        errno = EINVAL;
+        return NULL;
+    }
+    book_t *b = malloc(sizeof(book_t));
+    if (!b) {
+        munmap(map, len);
+        return NULL;
+    }
+    b->map = map;
+    b->len = len;
+    b->slots = (const book_entry_t *)(hdr + 1);
+    b->mask = (1ull << hdr->slot_bits) - 1;
+    b->entries = hdr->entries;
+    return b;
+}
+
+void book_close(book_t *b) {
+    if (!b) return;
+    munmap(b->map, b->len);
+    free(b);
+}
+
+uint64_t book_entries(const book_t *b) {
+    return b->entries;
+}
+
+static const book_entry_t *find(const book_entry_t *slots, uint64_t mask, uint64_t key) {
+    for (uint64_t i = key & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+        if (slots[i].key == key) return &slots[i];
+        if (slots[i].key == 0) return NULL;
+    }
+    return NULL;
+}
+
+int book_probe(const book_t *b, const int *board, int width, int height, const sim_player_t *players, int player_count, int me) {
+    int t;
+    uint64_t key = book_key(board, width, height, players, player_count, me, &t);
+    const book_entry_t *e = find(b->slots, b->mask, key);
+    if (!e) return -1;
+    for (int d = 0; d < 8; d++) {
+        if (sym_dir(t, d) == e->dir) return d;
+    }
+    return -1;
+}
+
+int book_builder_init(book_builder_t *bb, uint32_t slot_bits) {
+    bb->slots = calloc((size_t)1 << slot_bits, sizeof(book_entry_t));
+    bb->slot_bits = slot_bits;
+    bb->entries = 0;
+    return bb->slots ? 0 : -1;
+}
+
+void book_builder_free(book_builder_t *bb) {
+    free(bb->slots);
+    bb->slots = NULL;
+}
+
+bool book_builder_has(const book_builder_t *bb, uint64_t key) {
+    return find(bb->slots, (1ull << bb->slot_bits) - 1, key) != NULL;
+}
+
+int book_builder_put(book_builder_t *bb, const int *board, int width, int height, const sim_player_t *players, int player_count,
+                     int me, int dir, int value, int depth) {
+    uint64_t mask = (1ull << bb->slot_bits) - 1;
+    // Hasta la mitad de la tabla, así los sondeos siguen siendo cortos.
+    if (bb->entries >= (mask + 1) / 2) {
+        errno = ENOSPC;
+        return -1;
+    }
+    int t;
+    uint64_t key = book_key(board, width, height, players, player_count, me, &t);
+    uint64_t i = key & mask;
+    while (bb->slots[i].key != 0 && bb->slots[i].key != key) i = (i + 1) & mask;
+    book_entry_t *e = &bb->slots[i];
+    if (e->key == key && e->depth > depth) return 0;
+    if (e->key == 0) bb->entries++;
+    e->key = key;
+    e->dir = (uint8_t)sym_dir(t, dir);
+    e->value = (int16_t)(value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value);
+    e->depth = (uint8_t)(depth > 255 ? 255 : depth);
+    return 0;
+}
+
+int book_builder_write(const book_builder_t *bb, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+    book_header_t hdr = { .slot_bits = bb->slot_bits, .entries = bb->entries };
+    memcpy(hdr.magic, BOOK_MAGIC, 4);
+    fwrite(&hdr, sizeof(hdr), 1, f);
+    fwrite(bb->slots, sizeof(book_entry_t), (size_t)1 << bb->slot_bits, f);
+    if (ferror(f)) {
+        fclose(f);
+        return -1;
+    }
+    return fclose(f);
+}
@@ -0,0 +1,55 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include "sim.h"
+#include <stdint.h>
+
+// Libro de aperturas en disco: una tabla hash de direccionamiento abierto
+// (sondeo lineal) que los jugadores mapean de sólo lectura. La clave es el
+// hash canónico de la posición: el mínimo entre las simetrías del tablero
+// (8 si es cuadrado, 4 si no), así una posición y sus reflejos comparten
+// entrada. La jugada se guarda en el marco canónico y se deshace al consultar.
+
+typedef struct {
+    char magic[4];       // "CBK1"
+    uint32_t slot_bits;
+    uint64_t entries;
+} book_header_t;
+
+typedef struct {
+    uint64_t key;        // 0 = vacía
+    int16_t value;
+    uint8_t dir;         // en el marco canónico
+    uint8_t depth;
+    uint32_t reserved;
+} book_entry_t;
+
+typedef struct book book_t;
+
+// Hash canónico; en sym queda la simetría que lo realiza (puede ser NULL).
+uint64_t book_key(const int *board, int width, int height, const sim_player_t *players, int player_count, int me, int *sym);
+
+// mmap de sólo lectura; NULL y errno si no existe o no es un libro.
+book_t *book_open(const char *path);
+void book_close(book_t *b);
+uint64_t book_entries(const book_t *b);
+
+// Dirección del libro para me en esta posición, o -1 si no está.
+int book_probe(const book_t *b, const int *board, int width, int height, const sim_player_t *players, int player_count, int me);
+
+// Construcción offline (bookgen): la tabla vive en memoria hasta book_builder_write.
+typedef struct {
+    book_entry_t *slots;
+    uint32_t slot_bits;
+    uint64_t entries;
+} book_builder_t;
+
+int book_builder_init(book_builder_t *bb, uint32_t slot_bits);
+void book_builder_free(book_builder_t *bb);
+bool book_builder_has(const book_builder_t *bb, uint64_t key);
+// Guarda dir (en el marco real de la posición); una entrada más profunda no se pisa. -1 si está llena.
+int book_builder_put(book_builder_t *bb, const int *board, int width, int height, const sim_player_t *players, int player_count,
+                     int me, int dir, int value, int depth);
+int book_builder_write(const book_builder_t *bb, const char *path);
+
+#endif
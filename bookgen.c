@@ -0,0 +1,157 @@
+#include "common.h"
+#include "game.h"
+#include "strategy.h"
+#include "book.h"
+#include <getopt.h>
+
+// Genera el libro de aperturas: para cada semilla arma el tablero igual que
+// el máster (game_init_board + game_place_players) y recorre las posiciones
+// a menos de -D jugadas de la inicial, buscando cada una con la estrategia
+// (alfa-beta por defecto) y un presupuesto grande. Las posiciones simétricas
+// a una ya buscada se saltean.
+
+typedef struct {
+    int width;
+    int height;
+    int players;
+    int first_seed;
+    int seeds;
+    int plies;
+    strategy_budget_t budget;
+    strategy_engine_t engine;
+    uint32_t slot_bits;
+    const char *out;
+} bookgen_opts_t;
+
+typedef struct {
+    const bookgen_opts_t *o;
+    strategy_t *s;
+    book_builder_t bb;
+    unsigned long searched;
+} bookgen_t;
+
+static bool has_move(const int *board, int w, int h, sim_player_t *players, int p) {
+    for (int d = 0; d < 8; d++) {
+        if (sim_is_valid_move((int *)board, w, h, players, p, d)) return true;
+    }
+    return false;
+}
+
+// En el máster los jugadores mueven a medida que responden, no en ronda: cada
+// posición se busca para todos los que tienen jugada y se expande con las
+// jugadas de todos. Una posición siempre está a la misma cantidad de jugadas
+// de la raíz, así que si ya se visitó su subárbol ya está.
+static int expand(bookgen_t *g, int *board, sim_player_t *players, int ply) {
+    const bookgen_opts_t *o = g->o;
+    int w = o->width, h = o->height, pc = o->players;
+    int first = -1;
+    for (int p = 0; p < pc && first < 0; p++) {
+        if (!players[p].blocked && has_move(board, w, h, players, p)) first = p;
+    }
+    if (first < 0 || book_builder_has(&g->bb, book_key(board, w, h, players, pc, first, NULL))) return 0;
+
+    for (int p = first; p < pc; p++) {
+        if (players[p].blocked || !has_move(board, w, h, players, p)) continue;
+        strategy_state_t st = { .width = w, .height = h, .player_count = pc, .my_index = p, .board = board, .players = players };
+        int dir = strategy_decide(g->s, &st, &o->budget);
+        if (dir < 0) continue;
+        const strategy_stats_t *stats = strategy_last_stats(g->s);
+        int value = 0;
+        for (int c = 0; c < stats->candidate_count; c++) {
+            if (stats->candidates[c].dir == dir) value = (int)stats->candidates[c].value;
+        }
+        if (book_builder_put(&g->bb, board, w, h, players, pc, p, dir, value, stats->max_depth) == -1) return -1;
+        g->searched++;
+    }
+    if (ply + 1 >= o->plies) return 0;
+
+    for (int p = first; p < pc; p++) {
+        if (players[p].blocked) continue;
+        for (int d = 0; d < 8; d++) {
+            if (!sim_is_valid_move(board, w, h, players, p, d)) continue;
+            sim_player_t before = players[p];
+            int tx, ty;
+            game_target_from_dir(before.x, before.y, d, &tx, &ty);
+            int reward = board[ty * w + tx];
+            sim_apply_move(board, w, h, players, p, d);
+            int rc = expand(g, board, players, ply + 1);
+            board[ty * w + tx] = reward;
+            players[p] = before;
+            if (rc == -1) return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    bookgen_opts_t o = { .width = 10, .height = 10, .players = 2, .first_seed = 1, .seeds = 10, .plies = 2,
+                         .budget = { .time_ms = 50 }, .engine = STRATEGY_ENGINE_AB, .slot_bits = 16, .out = "book.bin" };
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:s:c:D:S:T:e:b:o:")) != -1) {
+        switch (opt) {
+            case 'w': o.width = atoi(optarg); break;
+            case 'h': o.height = atoi(optarg); break;
+            case 'n': o.players = atoi(optarg); break;
+            case 's': o.first_seed = atoi(optarg); break;
+            case 'c': o.seeds = atoi(optarg); break;
+            case 'D': o.plies = atoi(optarg); break;
+            case 'S': o.budget.max_sims = atoi(optarg); o.budget.time_ms = 0; break;
+            case 'T': o.budget.time_ms = atoi(optarg); break;
+            case 'e':
+                if (strategy_engine_parse(optarg, &o.engine) == -1) {
+                    fprintf(stderr, "Motor desconocido: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'b': o.slot_bits = (uint32_t)atoi(optarg); break;
+            case 'o': o.out = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-w ancho] [-h alto] [-n jugadores] [-s primera_semilla] [-c semillas] [-D jugadas] [-S sims | -T ms] [-e mc|ab|auto] [-b bits_tabla] [-o salida]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (o.width <= 0 || o.height <= 0 || o.players < 1 || o.players > MAX_PLAYERS || o.seeds <= 0 || o.slot_bits < 4 || o.slot_bits > 32) {
+        fprintf(stderr, "Parámetros inválidos\n");
+        return EXIT_FAILURE;
+    }
+    // Se busca siempre de cero, sin consultar un libro anterior.
+    unsetenv("CHOMP_BOOK");
+
+    bookgen_t g = { .o = &o };
+    game_state_t *gs = malloc(game_state_size(o.width, o.height));
+    g.s = strategy_create(o.width, o.height, o.players, (unsigned int)o.first_seed);
+    if (!gs || !g.s || strategy_set_engine(g.s, o.engine, 1) == -1 || book_builder_init(&g.bb, o.slot_bits) == -1) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    int rc = EXIT_SUCCESS;
+    sim_player_t players[MAX_PLAYERS];
+    for (int i = 0; i < o.seeds; i++) {
+        gs->width = o.width;
+        gs->height = o.height;
+        gs->player_count = (unsigned int)o.players;
+        for (int p = 0; p < o.players; p++) memset(&gs->players[p], 0, sizeof(player_t));
+        game_init_board(gs, o.first_seed + i);
+        game_place_players(gs);
+        strategy_players_from_state(players, gs->players, (unsigned int)o.players);
+        if (expand(&g, gs->board, players, 0) == -1) {
+            perror("book_builder_put");
+            rc = EXIT_FAILURE;
+            break;
+        }
+        fprintf(stderr, "bookgen: semilla %d, %lu posiciones\n", o.first_seed + i, g.searched);
+    }
+    if (rc == EXIT_SUCCESS) {
+        if (book_builder_write(&g.bb, o.out) == -1) {
+            perror(o.out);
+            rc = EXIT_FAILURE;
+        } else {
+            printf("%lu posiciones en %s (%u slots)\n", (unsigned long)g.bb.entries, o.out, 1u << o.slot_bits);
+        }
+    }
+    book_builder_free(&g.bb);
+    strategy_destroy(g.s);
+    free(gs);
+    return rc;
+}
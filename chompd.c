@@ -0,0 +1,323 @@
+#include "common.h"
+#include "shm_manager.h"
+#include "game.h"
+#include "referee.h"
+#include "spawn.h"
+#include "trace.h"
+#include "metrics.h"
+#include "telemetry.h"
+#include <getopt.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define DEFAULT_SOCKET_PATH "/tmp/chompd.sock"
+
+static game_state_t *game_state = NULL;
+static game_sync_t *game_sync = NULL;
+static shm_manager_t *state_mgr = NULL;
+static shm_manager_t *sync_mgr = NULL;
+static int player_pipes[MAX_PLAYERS][2];
+static char *pool_paths[MAX_PLAYERS];
+static int pool_count = 0;
+static int max_width = 100;
+static int max_height = 100;
+static int listen_fd = -1;
+static const char *socket_path = DEFAULT_SOCKET_PATH;
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static double elapsed_us(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1e6 + (b->tv_nsec - a->tv_nsec) / 1e3;
+}
+
+static int spawn_pool_player(int i) {
+    if (pipe(player_pipes[i]) == -1) {
+        perror("pipe");
+        return -1;
+    }
+    set_cloexec(player_pipes[i][PIPE_READ]);
+    set_cloexec(player_pipes[i][PIPE_WRITE]);
+
+    char width_str[16], height_str[16];
+    snprintf(width_str, sizeof(width_str), "%d", max_width);
+    snprintf(height_str, sizeof(height_str), "%d", max_height);
+    char *player_argv[] = { pool_paths[i], width_str, height_str, NULL };
+    pid_t pid = spawn_process(pool_paths[i], player_argv, player_pipes[i][PIPE_WRITE], NULL);
+    close(player_pipes[i][PIPE_WRITE]);
+    player_pipes[i][PIPE_WRITE] = -1;
+    if (pid == -1) {
+        perror("posix_spawn player");
+        close(player_pipes[i][PIPE_READ]);
+        player_pipes[i][PIPE_READ] = -1;
+        return -1;
+    }
+    game_state->players[i].pid = pid;
+    return 0;
+}
+
+static void reap_player(int i) {
+    if (player_pipes[i][PIPE_READ] != -1) {
+        close(player_pipes[i][PIPE_READ]);
+        player_pipes[i][PIPE_READ] = -1;
+    }
+    if (game_state->players[i].pid != 0) {
+        waitpid(game_state->players[i].pid, NULL, 0);
+        game_state->players[i].pid = 0;
+    }
+}
+
+// Descarta jugadas tardías hasta leer la marca de jugador libre.
+static int wait_player_idle(int i) {
+    for (;;) {
+        unsigned char b;
+        ssize_t n = read(player_pipes[i][PIPE_READ], &b, 1);
+        if (n == 1 && b == PLAYER_IDLE_MARK) return 0;
+        if (n == 1) continue;
+        if (n == -1 && errno == EINTR) continue;
+        return -1;
+    }
+}
+
+static int run_game(int width, int height, int seed, int delay_ms, int timeout_sec, char *reply, size_t reply_len) {
+    struct timespec t0, t1, t2;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (int i = 0; i < pool_count; i++) {
+        if (player_pipes[i][PIPE_READ] == -1) {
+            reap_player(i);
+            if (spawn_pool_player(i) == -1) {
+                snprintf(reply, reply_len, "ERR no se pudo relanzar Player%d\n", i + 1);
+                return -1;
+            }
+        }
+        while (sem_trywait(&game_sync->player_mutex[i]) == 0) {
+        }
+    }
+
+    sem_wait(&game_sync->master_mutex);
+    sem_wait(&game_sync->state_mutex);
+    game_state->width = width;
+    game_state->height = height;
+    game_state->player_count = pool_count;
+    for (int i = 0; i < pool_count; i++) {
+        game_state->players[i].score = 0;
+        game_state->players[i].invalid_moves = 0;
+        game_state->players[i].valid_moves = 0;
+        game_state->players[i].blocked = false;
+    }
+    game_init_board(game_state, seed);
+    game_place_players(game_state);
+    game_state->game_over = false;
+    sem_post(&game_sync->state_mutex);
+    sem_post(&game_sync->master_mutex);
+    if (telemetry) atomic_store(&telemetry->game_over, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    referee_t ref = {
+        .state = game_state,
+        .sync = game_sync,
+        .pipes = player_pipes,
+        .player_count = pool_count,
+        .delay_ms = delay_ms,
+        .timeout_sec = timeout_sec,
+        .with_view = false
+    };
+    referee_run(&ref);
+    referee_finish(&ref);
+
+    for (int i = 0; i < pool_count; i++) {
+        if (player_pipes[i][PIPE_READ] == -1) continue;
+        if (wait_player_idle(i) == -1) reap_player(i);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+
+    int winner = game_pick_winner(game_state);
+    unsigned int moves = 0;
+    for (int i = 0; i < pool_count; i++) moves += game_state->players[i].valid_moves;
+    snprintf(reply, reply_len, "OK winner=%d score=%u moves=%u setup_us=%.1f game_ms=%.3f\n",
+             winner + 1, winner >= 0 ? game_state->players[winner].score : 0u, moves,
+             elapsed_us(&t0, &t1), elapsed_us(&t1, &t2) / 1000.0);
+    return 0;
+}
+
+// Formato de pedido: "<ancho> <alto> [seed] [delay_ms] [timeout_s]"
+static int handle_request(const char *line, char *reply, size_t reply_len) {
+    int width = 0, height = 0;
+    int seed = (int)time(NULL);
+    int delay_ms = 0;
+    int timeout_sec = 10;
+    int n = sscanf(line, "%d %d %d %d %d", &width, &height, &seed, &delay_ms, &timeout_sec);
+    if (n < 2 || width < 1 || height < 1 || width > max_width || height > max_height || delay_ms < 0 || timeout_sec < 1) {
+        snprintf(reply, reply_len, "ERR pedido inválido (máximo %dx%d)\n", max_width, max_height);
+        return -1;
+    }
+    return run_game(width, height, seed, delay_ms, timeout_sec, reply, reply_len);
+}
+
+static void serve_connection(int conn) {
+    FILE *f = fdopen(conn, "r+");
+    if (!f) {
+        close(conn);
+        return;
+    }
+    char line[256];
+    char reply[256];
+    while (!stop_requested && fgets(line, sizeof(line), f) != NULL) {
+        if (strncmp(line, "shutdown", 8) == 0) {
+            stop_requested = 1;
+            fputs("OK bye\n", f);
+            break;
+        }
+        handle_request(line, reply, sizeof(reply));
+        fputs(reply, f);
+        fflush(f);
+    }
+    fclose(f);
+}
+
+static int run_client(void) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) { perror("socket"); return EXIT_FAILURE; }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) { perror("connect"); close(fd); return EXIT_FAILURE; }
+
+    FILE *f = fdopen(fd, "r+");
+    if (!f) { perror("fdopen"); close(fd); return EXIT_FAILURE; }
+    char line[256];
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        fputs(line, f);
+        fflush(f);
+        if (fgets(line, sizeof(line), f) == NULL) break;
+        fputs(line, stdout);
+        fflush(stdout);
+    }
+    fclose(f);
+    return EXIT_SUCCESS;
+}
+
+static void shutdown_pool(void) {
+    if (game_state != NULL && game_sync != NULL) {
+        game_state->game_over = true;
+        for (int i = 0; i < pool_count; i++) {
+            if (game_state->players[i].pid != 0) kill(game_state->players[i].pid, SIGTERM);
+            sem_post(&game_sync->player_mutex[i]);
+        }
+        for (int i = 0; i < pool_count; i++) reap_player(i);
+        referee_sync_destroy(game_sync);
+    }
+    if (state_mgr) shm_manager_destroy(state_mgr);
+    if (sync_mgr) shm_manager_destroy(sync_mgr);
+    telemetry_destroy();
+    if (listen_fd != -1) {
+        close(listen_fd);
+        unlink(socket_path);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bool client = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "S:W:H:p:c")) != -1) {
+        switch (opt) {
+            case 'S': socket_path = optarg; break;
+            case 'W': max_width = atoi(optarg); break;
+            case 'H': max_height = atoi(optarg); break;
+            case 'c': client = true; break;
+            case 'p':
+                if (pool_count < MAX_PLAYERS) pool_paths[pool_count++] = optarg;
+                else fprintf(stderr, "Máximo de jugadores alcanzado (%d)\n", MAX_PLAYERS);
+                break;
+            default:
+                fprintf(stderr, "Uso: %s [-S socket] [-W max_width] [-H max_height] -p player1 [player2 ...]\n"
+                                "     %s [-S socket] -c   (cliente: pedidos por stdin)\n", argv[0], argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (client) return run_client();
+
+    while (optind < argc && pool_count < MAX_PLAYERS) {
+        pool_paths[pool_count++] = argv[optind++];
+    }
+    if (pool_count == 0 || max_width < 1 || max_height < 1) {
+        fprintf(stderr, "Debe especificar al menos un jugador y un tablero máximo válido\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    metrics_install_sigusr1();
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        player_pipes[i][PIPE_READ] = -1;
+        player_pipes[i][PIPE_WRITE] = -1;
+    }
+
+    state_mgr = shm_manager_create(SHM_GAME_STATE, game_state_size(max_width, max_height), 0666, 0, 0);
+    if (!state_mgr) { perror("shm_manager_create state"); exit(EXIT_FAILURE); }
+    game_state = (game_state_t *)shm_manager_data(state_mgr);
+
+    sync_mgr = shm_manager_create(SHM_GAME_SYNC, sizeof(game_sync_t), 0666, 0, 0);
+    if (!sync_mgr) { perror("shm_manager_create sync"); shm_manager_destroy(state_mgr); exit(EXIT_FAILURE); }
+    game_sync = (game_sync_t *)shm_manager_data(sync_mgr);
+    if (referee_sync_init(game_sync) == -1) { shutdown_pool(); exit(EXIT_FAILURE); }
+    if (trace_create() == -1) { shutdown_pool(); exit(EXIT_FAILURE); }
+    trace_attach("chompd");
+    if (telemetry_create(pool_count) == -1) { shutdown_pool(); exit(EXIT_FAILURE); }
+
+    game_state->width = max_width;
+    game_state->height = max_height;
+    game_state->player_count = pool_count;
+    game_state->game_over = false;
+    for (int i = 0; i < pool_count; i++) {
+        snprintf(game_state->players[i].name, 16, "Player%d", (unsigned char)(i + 1));
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd == -1) { perror("socket"); shutdown_pool(); exit(EXIT_FAILURE); }
+    set_cloexec(listen_fd);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(listen_fd, 8) == -1) {
+        perror("bind/listen");
+        close(listen_fd);
+        listen_fd = -1;
+        shutdown_pool();
+        exit(EXIT_FAILURE);
+    }
+
+    setenv("CHOMP_POOL", "1", 1);
+    for (int i = 0; i < pool_count; i++) {
+        if (spawn_pool_player(i) == -1) { shutdown_pool(); exit(EXIT_FAILURE); }
+    }
+
+    fprintf(stderr, "chompd: escuchando en %s (%d jugadores, tablero máximo %dx%d)\n",
+            socket_path, pool_count, max_width, max_height);
+
+    while (!stop_requested) {
+        int conn = accept(listen_fd, NULL, NULL);
+        if (conn == -1) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        serve_connection(conn);
+    }
+
+    shutdown_pool();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include "common.h"
+#include "shm_manager.h"
+#include "telemetry.h"
+#include "metrics.h"
+#include <getopt.h>
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static double ms(uint64_t ns) {
+    return (double)ns / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    int interval_ms = 1000;
+    int iterations = -1;
+    bool clear = true;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:b")) != -1) {
+        switch (opt) {
+            case 'i': interval_ms = atoi(optarg); break;
+            case 'n': iterations = atoi(optarg); break;
+            case 'b': clear = false; break;
+            default:
+                fprintf(stderr, "Uso: %s [-i intervalo_ms] [-n iteraciones] [-b]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (interval_ms < 10) interval_ms = 10;
+
+    shm_manager_t *mgr = shm_manager_open_readonly(SHM_GAME_TELEMETRY, sizeof(telemetry_t));
+    if (!mgr) {
+        perror("shm_manager_open " SHM_GAME_TELEMETRY);
+        return EXIT_FAILURE;
+    }
+    const telemetry_t *t = shm_manager_data(mgr);
+    if (t->magic != TELEMETRY_MAGIC || t->version != TELEMETRY_VERSION || t->size != sizeof(telemetry_t)) {
+        fprintf(stderr, "chompstat: versión de telemetría incompatible (%u, se esperaba %u)\n", t->version, TELEMETRY_VERSION);
+        shm_manager_close(mgr);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    uint64_t prev_moves = 0, prev_ns = 0;
+    uint64_t prev_decisions[MAX_PLAYERS] = {0};
+    for (int it = 0; !stop_requested && (iterations < 0 || it < iterations); it++) {
+        uint64_t now = metrics_now_ns();
+        uint64_t valid = atomic_load(&t->moves_valid);
+        uint64_t invalid = atomic_load(&t->moves_invalid);
+        uint64_t moves = valid + invalid;
+        double dt = prev_ns ? (double)(now - prev_ns) / 1e9 : 0.0;
+        double rate = dt > 0 ? (double)(moves - prev_moves) / dt : 0.0;
+        unsigned int pc = atomic_load(&t->player_count);
+        if (pc > MAX_PLAYERS) pc = MAX_PLAYERS;
+
+        if (clear) printf("\033[2J\033[H");
+        printf("chompstat — master %d  %s  uptime %.1f s\n", (int)atomic_load(&t->master_pid),
+               atomic_load(&t->game_over) ? "terminado" : "jugando",
+               (double)(now - atomic_load(&t->start_ns)) / 1e9);
+        printf("jugadas: %llu (%.1f/s)  inválidas: %.2f%%  espera de locks: %.3f ms  RSS: %llu KiB\n\n",
+               (unsigned long long)moves, rate, moves ? 100.0 * (double)invalid / (double)moves : 0.0,
+               ms(atomic_load(&t->lock_wait_ns)), (unsigned long long)atomic_load(&t->rss_kb));
+        printf("%-8s %7s %8s %10s %10s %10s %7s %7s %10s %9s %9s %7s\n",
+               "jugador", "pid", "decis.", "piensa ms", "media ms", "sims/s", "prof.", "máx", "locks ms", "RSS KiB",
+               "turno µs", "spin %");
+        for (unsigned int i = 0; i < pc; i++) {
+            const telemetry_player_t *p = &t->players[i];
+            uint64_t d = atomic_load(&p->decisions);
+            uint64_t tokens = atomic_load(&p->tokens);
+            uint64_t hits = atomic_load(&p->spin_hits), spins = hits + atomic_load(&p->spin_misses);
+            char spin_pct[16] = "-";
+            if (spins) snprintf(spin_pct, sizeof(spin_pct), "%.1f", 100.0 * (double)hits / (double)spins);
+            printf("P%-7u %7d %8llu %10.2f %10.2f %10llu %7u %7u %10.3f %9llu %9.1f %7s%s\n",
+                   i + 1, (int)atomic_load(&p->pid), (unsigned long long)d,
+                   ms(atomic_load(&p->think_ns_last)), d ? ms(atomic_load(&p->think_ns_total)) / (double)d : 0.0,
+                   (unsigned long long)atomic_load(&p->sims_per_sec), atomic_load(&p->depth_avg),
+                   atomic_load(&p->depth_max), ms(atomic_load(&p->lock_wait_ns)),
+                   (unsigned long long)atomic_load(&p->rss_kb),
+                   tokens ? (double)atomic_load(&p->wake_ns_total) / (double)tokens / 1e3 : 0.0,
+                   spin_pct, d == prev_decisions[i] && prev_ns ? "  (inactivo)" : "");
+            prev_decisions[i] = d;
+        }
+        fflush(stdout);
+        prev_moves = moves;
+        prev_ns = now;
+
+        struct timespec ts = { interval_ms / 1000, (long)(interval_ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+
+    shm_manager_close(mgr);
+    return EXIT_SUCCESS;
+}
@@ -17,12 +17,16 @@
 #include <errno.h>
 #include <signal.h>
 #include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 #define MAX_PLAYERS 9
 #define SHM_GAME_STATE "/game_state"
 #define SHM_GAME_SYNC "/game_sync"
 #define PIPE_READ 0
 #define PIPE_WRITE 1
+// Byte que un jugador en modo pool (CHOMP_POOL) envía al quedar libre entre partidas
+#define PLAYER_IDLE_MARK 0xFF
 
 // Estructura para el jugador
 typedef struct {
@@ -54,6 +58,10 @@ typedef struct {
     sem_t reader_count_mutex;
     unsigned int reader_count;
     sem_t player_mutex[MAX_PLAYERS];
+    // Al final para no mover los campos anteriores: tokens entregados a cada jugador (turnwait.h).
+    _Atomic unsigned int turn_seq[MAX_PLAYERS];
+    // CLOCK_MONOTONIC de la última entrega, para medir cuánto tarda el jugador en despertar.
+    _Atomic uint64_t turn_release_ns[MAX_PLAYERS];
 } game_sync_t;
 
 // Direcciones de movimiento
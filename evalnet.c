@@ -0,0 +1,190 @@
+#include "evalnet.h"
+#include "game.h"
+#include "sim.h"
+#include <stdatomic.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define EVALNET_X86 1
+#include <immintrin.h>
+#endif
+
+#define EVALNET_MAGIC "CEV1"
+
+int evalnet_load(evalnet_t *net, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    char magic[4];
+    uint32_t dims[2];
+    int ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, EVALNET_MAGIC, 4) == 0 &&
+             fread(dims, sizeof(uint32_t), 2, f) == 2 && dims[0] == EVALNET_INPUTS && dims[1] == EVALNET_HIDDEN &&
+             fread(net->mean, sizeof(float), EVALNET_INPUTS, f) == EVALNET_INPUTS &&
+             fread(net->inv_std, sizeof(float), EVALNET_INPUTS, f) == EVALNET_INPUTS &&
+             fread(net->w1, sizeof(float), EVALNET_INPUTS * EVALNET_HIDDEN, f) == EVALNET_INPUTS * EVALNET_HIDDEN &&
+             fread(net->b1, sizeof(float), EVALNET_HIDDEN, f) == EVALNET_HIDDEN &&
+             fread(net->w2, sizeof(float), EVALNET_HIDDEN, f) == EVALNET_HIDDEN &&
+             fread(&net->b2, sizeof(float), 1, f) == 1 && fread(&net->scale, sizeof(float), 1, f) == 1;
+    fclose(f);
+    if (!ok) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int evalnet_save(const evalnet_t *net, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+    uint32_t dims[2] = { EVALNET_INPUTS, EVALNET_HIDDEN };
+    fwrite(EVALNET_MAGIC, 1, 4, f);
+    fwrite(dims, sizeof(uint32_t), 2, f);
+    fwrite(net->mean, sizeof(float), EVALNET_INPUTS, f);
+    fwrite(net->inv_std, sizeof(float), EVALNET_INPUTS, f);
+    fwrite(net->w1, sizeof(float), EVALNET_INPUTS * EVALNET_HIDDEN, f);
+    fwrite(net->b1, sizeof(float), EVALNET_HIDDEN, f);
+    fwrite(net->w2, sizeof(float), EVALNET_HIDDEN, f);
+    fwrite(&net->b2, sizeof(float), 1, f);
+    fwrite(&net->scale, sizeof(float), 1, f);
+    if (ferror(f)) {
+        fclose(f);
+        return -1;
+    }
+    return fclose(f);
+}
+
+static int free_around(const int *board, int width, int height, int x, int y, int radius, int *reward) {
+    int n = 0;
+    int sum = 0;
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            int nx = x + dx;
+            int ny = y + dy;
+            if ((dx == 0 && dy == 0) || nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int v = board[ny * width + nx];
+            if (v > 0) {
+                n++;
+                sum += v;
+            }
+        }
+    }
+    if (reward) *reward = sum;
+    return n;
+}
+
+// 0 margen de puntos, 1 margen de territorio, 2 territorio propio, 3 y 4
+// libertades propias y del rival, 5 recompensa libre en el 5x5 propio,
+// 6 fracción de celdas libres, 7 distancia (Chebyshev) al rival. El rival es
+// el que más tiene entre puntos y territorio.
+void evalnet_features(const int *board, int width, int height, const sim_player_t *players, int player_count,
+                      int me, const unsigned int *vor, float *features) {
+    int opp = -1;
+    long best = -1;
+    for (int q = 0; q < player_count; q++) {
+        if (q == me) continue;
+        long v = (long)players[q].score + (long)vor[q];
+        if (v > best) {
+            best = v;
+            opp = q;
+        }
+    }
+    int cells = width * height;
+    int free_cells = 0;
+    for (int i = 0; i < cells; i++) free_cells += board[i] > 0;
+
+    const sim_player_t *m = &players[me];
+    int ring = 0;
+    free_around(board, width, height, m->x, m->y, 2, &ring);
+    features[0] = (float)m->score - (opp >= 0 ? (float)players[opp].score : 0.0f);
+    features[1] = (float)vor[me] - (opp >= 0 ? (float)vor[opp] : 0.0f);
+    features[2] = (float)vor[me];
+    features[3] = m->blocked ? 0.0f : (float)free_around(board, width, height, m->x, m->y, 1, NULL);
+    features[4] = opp < 0 || players[opp].blocked ? 0.0f
+                                                  : (float)free_around(board, width, height, players[opp].x, players[opp].y, 1, NULL);
+    features[5] = (float)ring;
+    features[6] = (float)free_cells / (float)cells;
+    if (opp >= 0) {
+        int dx = abs(m->x - players[opp].x);
+        int dy = abs(m->y - players[opp].y);
+        features[7] = (float)(dx > dy ? dx : dy);
+    } else {
+        features[7] = 0.0f;
+    }
+}
+
+static float predict_scalar(const evalnet_t *net, const float *features) {
+    float x[EVALNET_INPUTS];
+    for (int i = 0; i < EVALNET_INPUTS; i++) x[i] = (features[i] - net->mean[i]) * net->inv_std[i];
+    float out = net->b2;
+    for (int j = 0; j < EVALNET_HIDDEN; j++) {
+        float h = net->b1[j];
+        for (int i = 0; i < EVALNET_INPUTS; i++) h += x[i] * net->w1[i][j];
+        if (h > 0.0f) out += h * net->w2[j];
+    }
+    return out * net->scale;
+}
+
+#ifdef EVALNET_X86
+// AVX2: las 16 ocultas en dos registros; cada entrada es un broadcast y dos FMA.
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+static float predict_avx2(const evalnet_t *net, const float *features) {
+    _Alignas(32) float x[EVALNET_INPUTS];
+    __m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(features), _mm256_load_ps(net->mean)), _mm256_load_ps(net->inv_std));
+    _mm256_store_ps(x, v);
+    __m256 h0 = _mm256_load_ps(net->b1);
+    __m256 h1 = _mm256_load_ps(net->b1 + 8);
+    for (int i = 0; i < EVALNET_INPUTS; i++) {
+        __m256 xi = _mm256_set1_ps(x[i]);
+        h0 = _mm256_fmadd_ps(xi, _mm256_load_ps(net->w1[i]), h0);
+        h1 = _mm256_fmadd_ps(xi, _mm256_load_ps(net->w1[i] + 8), h1);
+    }
+    __m256 zero = _mm256_setzero_ps();
+    h0 = _mm256_max_ps(h0, zero);
+    h1 = _mm256_max_ps(h1, zero);
+    __m256 acc = _mm256_fmadd_ps(h1, _mm256_load_ps(net->w2 + 8), _mm256_mul_ps(h0, _mm256_load_ps(net->w2)));
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return (_mm_cvtss_f32(s) + net->b2) * net->scale;
+}
+#pragma GCC pop_options
+#endif
+
+typedef struct {
+    float (*fn)(const evalnet_t *, const float *);
+    const char *isa;
+} predict_variant_t;
+
+static const predict_variant_t predict_scalar_variant = { predict_scalar, "scalar" };
+#ifdef EVALNET_X86
+static const predict_variant_t predict_avx2_variant = { predict_avx2, "avx2" };
+#endif
+
+// La inferencia sigue a la variante de sim elegida (--kernel=, CHOMP_KERNEL o
+// auto): con scalar o sse4.2 usa la escalar. Se vuelve a elegir si cambia.
+static _Atomic(const sim_kernels_t *) predict_for;
+static _Atomic(const predict_variant_t *) predict_active = &predict_scalar_variant;
+
+static const predict_variant_t *select_predict(void) {
+    const sim_kernels_t *k = sim_kernels();
+    if (atomic_load_explicit(&predict_for, memory_order_acquire) == k) {
+        return atomic_load_explicit(&predict_active, memory_order_relaxed);
+    }
+    const predict_variant_t *v = &predict_scalar_variant;
+#ifdef EVALNET_X86
+    bool wide = strcmp(k->name, "avx2") == 0 || strcmp(k->name, "avx512") == 0;
+    __builtin_cpu_init();
+    if (wide && __builtin_cpu_supports("fma")) v = &predict_avx2_variant;
+#endif
+    atomic_store_explicit(&predict_active, v, memory_order_relaxed);
+    atomic_store_explicit(&predict_for, k, memory_order_release);
+    return v;
+}
+
+float evalnet_predict(const evalnet_t *net, const float *features) {
+    return select_predict()->fn(net, features);
+}
+
+const char *evalnet_isa(void) {
+    return select_predict()->isa;
+}
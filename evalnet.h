@@ -0,0 +1,40 @@
+#ifndef EVALNET_H
+#define EVALNET_H
+
+#include "sim.h"
+
+// Evaluador aprendido: un MLP chico (EVALNET_INPUTS -> EVALNET_HIDDEN ReLU -> 1)
+// sobre rasgos de la posición que predice el margen final del jugador (sus
+// puntos menos los del mejor rival). Se entrena offline con evaltrain y
+// reemplaza las playouts: una evaluación es un BFS de Voronoi y unas decenas
+// de FMA (AVX2 si la CPU lo soporta).
+#define EVALNET_INPUTS 8
+#define EVALNET_HIDDEN 16
+
+typedef struct {
+    _Alignas(32) float mean[EVALNET_INPUTS];
+    _Alignas(32) float inv_std[EVALNET_INPUTS];
+    _Alignas(32) float w1[EVALNET_INPUTS][EVALNET_HIDDEN];
+    _Alignas(32) float b1[EVALNET_HIDDEN];
+    _Alignas(32) float w2[EVALNET_HIDDEN];
+    float b2;
+    float scale;   // salida * scale = margen en puntos
+} evalnet_t;
+
+// Archivo: "CEV1", entradas y ocultas (uint32) y los campos en orden. -1 y errno.
+int evalnet_load(evalnet_t *net, const char *path);
+int evalnet_save(const evalnet_t *net, const char *path);
+
+// Rasgos desde el punto de vista de me; vor es la salida del BFS de Voronoi
+// sobre la misma posición.
+void evalnet_features(const int *board, int width, int height, const sim_player_t *players, int player_count,
+                      int me, const unsigned int *vor, float *features);
+
+// Margen final previsto en puntos.
+float evalnet_predict(const evalnet_t *net, const float *features);
+
+// "avx2" o "scalar": sigue a la variante de sim activa (sim_kernel_select,
+// --kernel= o CHOMP_KERNEL); scalar y sse4.2 usan la escalar.
+const char *evalnet_isa(void);
+
+#endif
@@ -0,0 +1,391 @@
+#include "common.h"
+#include "game.h"
+#include "strategy.h"
+#include "evalnet.h"
+#include "samples.h"
+#include <getopt.h>
+#include <math.h>
+
+// Entrenamiento offline del evaluador aprendido: juega partidas contra sí
+// mismo con la búsqueda Monte Carlo (más un epsilon de jugadas al azar),
+// guarda los rasgos de cada posición tras la jugada de quien movió y el
+// margen final que terminó sacando, y ajusta el MLP de evalnet con SGD.
+// Con -i las posiciones salen de un archivo de selfplay en vez de jugarlas.
+
+typedef struct {
+    float f[EVALNET_INPUTS];
+    float y;
+    int game;
+    int player;
+} sample_t;
+
+typedef struct {
+    sample_t *v;
+    size_t n;
+    size_t cap;
+} samples_t;
+
+typedef struct {
+    int width;
+    int height;
+    int players;
+    int games;
+    int sims;
+    double epsilon;
+    int epochs;
+    unsigned int seed;
+    const char *input;
+    const char *out;
+} train_opts_t;
+
+static int push_sample(samples_t *s, const float *f, int game, int player) {
+    if (s->n == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 4096;
+        sample_t *v = realloc(s->v, cap * sizeof(sample_t));
+        if (!v) return -1;
+        s->v = v;
+        s->cap = cap;
+    }
+    sample_t *e = &s->v[s->n++];
+    memcpy(e->f, f, sizeof(e->f));
+    e->game = game;
+    e->player = player;
+    return 0;
+}
+
+static float frand(unsigned int *rng) {
+    return (float)(sim_rng_next(rng) & 0xFFFFFF) / (float)0x1000000;
+}
+
+typedef struct {
+    const train_opts_t *o;
+    strategy_t **seats;
+    strategy_budget_t budget;
+    unsigned int rng;
+    sim_player_t sp[MAX_PLAYERS];
+    unsigned int vor[MAX_PLAYERS];
+    sim_voronoi_ws_t ws;
+    samples_t *out;
+    game_state_t *gs;
+    int game;
+} self_play_t;
+
+static int self_play_decide(void *arg, const game_state_t *gs, int i) {
+    self_play_t *t = arg;
+    const train_opts_t *o = t->o;
+    if (frand(&t->rng) < o->epsilon) {
+        int dirs[8], n = 0;
+        for (int d = 0; d < 8; d++) {
+            if (game_is_valid_move_locked(gs, i, (direction_t)d)) dirs[n++] = d;
+        }
+        return n ? dirs[sim_rng_next(&t->rng) % n] : -1;
+    }
+    strategy_players_from_state(t->sp, gs->players, o->players);
+    strategy_state_t st = { .width = o->width, .height = o->height, .player_count = o->players, .my_index = i,
+                            .board = gs->board, .players = t->sp };
+    return strategy_decide(t->seats[i], &st, &t->budget);
+}
+
+static int self_play_on_move(void *arg, const game_state_t *gs, int i, int move) {
+    self_play_t *t = arg;
+    const train_opts_t *o = t->o;
+    (void)move;
+    strategy_players_from_state(t->sp, gs->players, o->players);
+    compute_voronoi_potential_buf(t->gs->board, o->width, o->height, t->sp, o->players, t->vor, &t->ws);
+    float f[EVALNET_INPUTS];
+    evalnet_features(gs->board, o->width, o->height, t->sp, o->players, i, t->vor, f);
+    return push_sample(t->out, f, t->game, i);
+}
+
+static int self_play(const train_opts_t *o, samples_t *out) {
+    int w = o->width, h = o->height, pc = o->players, cells = w * h;
+    game_state_t *gs = malloc(game_state_size(w, h));
+    strategy_t *seats[MAX_PLAYERS] = {0};
+    self_play_t t = {
+        .o = o, .seats = seats, .budget = { .max_sims = o->sims }, .rng = o->seed ? o->seed : 1, .out = out, .gs = gs,
+        .ws = {
+            .dist = malloc(sizeof(uint16_t) * cells),
+            .owner = malloc(sizeof(int8_t) * cells),
+            .queue = malloc(sizeof(uint32_t) * cells)
+        }
+    };
+    game_local_hooks_t hooks = { .decide = self_play_decide, .on_move = self_play_on_move, .ctx = &t };
+    int rc = -1;
+    if (!gs || !t.ws.dist || !t.ws.owner || !t.ws.queue) goto out;
+    for (int i = 0; i < pc; i++) {
+        seats[i] = strategy_create(w, h, pc, o->seed * 31 + (unsigned int)i + 1);
+        if (!seats[i]) goto out;
+    }
+
+    for (int g = 0; g < o->games; g++) {
+        size_t first = out->n;
+        t.game = g;
+        if (game_play_local(gs, w, h, pc, o->seed + (unsigned int)g, &hooks) == -1) goto out;
+        for (size_t k = first; k < out->n; k++) {
+            int p = out->v[k].player;
+            long best = 0;
+            bool any = false;
+            for (int q = 0; q < pc; q++) {
+                if (q == p) continue;
+                if (!any || (long)gs->players[q].score > best) best = gs->players[q].score;
+                any = true;
+            }
+            out->v[k].y = (float)((long)gs->players[p].score - best);
+        }
+        if ((g + 1) % 10 == 0) fprintf(stderr, "evaltrain: %d/%d partidas, %zu muestras\n", g + 1, o->games, out->n);
+    }
+    rc = 0;
+out:
+    for (int i = 0; i < pc; i++) strategy_destroy(seats[i]);
+    free(t.ws.dist);
+    free(t.ws.owner);
+    free(t.ws.queue);
+    free(gs);
+    return rc;
+}
+
+static int cmp_game(const void *a, const void *b) {
+    const sample_t *x = a, *y = b;
+    return (x->game > y->game) - (x->game < y->game);
+}
+
+// Lee las muestras de selfplay: cada fila es la posición antes de mover, así
+// que se aplica la jugada para sacar los rasgos igual que en self_play. El
+// tamaño del tablero y los jugadores salen del archivo.
+static int load_samples(train_opts_t *o, samples_t *out) {
+    samples_reader_t r;
+    if (samples_reader_open(&r, o->input) == -1) {
+        perror(o->input);
+        return -1;
+    }
+    int w = r.hdr.width, h = r.hdr.height, pc = r.hdr.player_count, cells = w * h;
+    o->width = w;
+    o->height = h;
+    o->players = pc;
+    samples_block_t b;
+    bool have_block = samples_block_init(&b, w, h, pc, r.hdr.block_samples) == 0;
+    int8_t *raw = malloc((size_t)cells);
+    int *board = malloc(sizeof(int) * (size_t)cells);
+    sim_voronoi_ws_t ws = {
+        .dist = malloc(sizeof(uint16_t) * cells),
+        .owner = malloc(sizeof(int8_t) * cells),
+        .queue = malloc(sizeof(uint32_t) * cells)
+    };
+    int rc = -1, got;
+    if (!have_block || !raw || !board || !ws.dist || !ws.owner || !ws.queue) goto out;
+
+    samples_row_t row = { .board = raw };
+    unsigned int vor[MAX_PLAYERS];
+    int max_game = -1;
+    while ((got = samples_read_block(&r, &b)) == 1) {
+        for (uint32_t i = 0; i < b.count; i++) {
+            samples_block_get(&b, i, &row);
+            int me = row.to_move;
+            if (me >= pc) continue;
+            for (int c = 0; c < cells; c++) board[c] = row.board[c];
+            if (sim_apply_move(board, w, h, row.players, me, row.move) == -1) continue;
+            compute_voronoi_potential_buf(board, w, h, row.players, pc, vor, &ws);
+            float f[EVALNET_INPUTS];
+            evalnet_features(board, w, h, row.players, pc, me, vor, f);
+            if (push_sample(out, f, (int)row.game, me) == -1) goto out;
+            long best = 0;
+            bool any = false;
+            for (int q = 0; q < pc; q++) {
+                if (q == me) continue;
+                if (!any || (long)row.final_score[q] > best) best = row.final_score[q];
+                any = true;
+            }
+            out->v[out->n - 1].y = (float)((long)row.final_score[me] - best);
+            if ((int)row.game > max_game) max_game = (int)row.game;
+        }
+    }
+    if (got == -1) {
+        fprintf(stderr, "%s: archivo corrupto\n", o->input);
+        goto out;
+    }
+    // Los hilos de selfplay intercalan bloques: se ordena por partida para
+    // que la validación siga siendo el último 10% de las partidas.
+    qsort(out->v, out->n, sizeof(sample_t), cmp_game);
+    o->games = max_game + 1;
+    rc = 0;
+out:
+    if (have_block) samples_block_free(&b);
+    free(ws.dist);
+    free(ws.owner);
+    free(ws.queue);
+    free(board);
+    free(raw);
+    samples_reader_close(&r);
+    return rc;
+}
+
+// Forward con los rasgos ya normalizados; deja las ocultas en h.
+static float forward(const evalnet_t *net, const float *x, float *h) {
+    float out = net->b2;
+    for (int j = 0; j < EVALNET_HIDDEN; j++) {
+        float a = net->b1[j];
+        for (int i = 0; i < EVALNET_INPUTS; i++) a += x[i] * net->w1[i][j];
+        h[j] = a > 0.0f ? a : 0.0f;
+        out += h[j] * net->w2[j];
+    }
+    return out;
+}
+
+static double rmse(const evalnet_t *net, const sample_t *v, size_t from, size_t to) {
+    double se = 0.0;
+    for (size_t k = from; k < to; k++) {
+        float d = evalnet_predict(net, v[k].f) - v[k].y;
+        se += (double)d * d;
+    }
+    return to > from ? sqrt(se / (double)(to - from)) : 0.0;
+}
+
+static void train(const train_opts_t *o, samples_t *s, evalnet_t *net) {
+    // Validación: el último 10% de las partidas (no posiciones sueltas, que
+    // dentro de una partida están muy correlacionadas).
+    int val_game = o->games - (o->games + 9) / 10;
+    size_t n_train = 0;
+    while (n_train < s->n && s->v[n_train].game < val_game) n_train++;
+    if (n_train == 0) n_train = s->n;
+
+    memset(net, 0, sizeof(*net));
+    double mean_y = 0.0, var_y = 0.0;
+    for (size_t k = 0; k < n_train; k++) mean_y += s->v[k].y;
+    mean_y /= (double)n_train;
+    for (size_t k = 0; k < n_train; k++) var_y += (s->v[k].y - mean_y) * (s->v[k].y - mean_y);
+    net->scale = (float)sqrt(var_y / (double)n_train);
+    if (net->scale < 1.0f) net->scale = 1.0f;
+    for (int i = 0; i < EVALNET_INPUTS; i++) {
+        double m = 0.0, v = 0.0;
+        for (size_t k = 0; k < n_train; k++) m += s->v[k].f[i];
+        m /= (double)n_train;
+        for (size_t k = 0; k < n_train; k++) v += (s->v[k].f[i] - m) * (s->v[k].f[i] - m);
+        v = sqrt(v / (double)n_train);
+        net->mean[i] = (float)m;
+        net->inv_std[i] = v > 1e-6 ? (float)(1.0 / v) : 0.0f;
+    }
+
+    unsigned int rng = o->seed * 2654435761u + 1;
+    float he = sqrtf(2.0f / EVALNET_INPUTS);
+    for (int i = 0; i < EVALNET_INPUTS; i++) {
+        for (int j = 0; j < EVALNET_HIDDEN; j++) net->w1[i][j] = (frand(&rng) * 2.0f - 1.0f) * he;
+    }
+    for (int j = 0; j < EVALNET_HIDDEN; j++) net->w2[j] = (frand(&rng) * 2.0f - 1.0f) * sqrtf(1.0f / EVALNET_HIDDEN);
+    net->b2 = (float)(mean_y / net->scale);
+
+    double base = 0.0;
+    for (size_t k = n_train; k < s->n; k++) base += (s->v[k].y - mean_y) * (s->v[k].y - mean_y);
+    if (s->n > n_train) base = sqrt(base / (double)(s->n - n_train));
+
+    size_t *order = malloc(n_train * sizeof(size_t));
+    if (!order) return;
+    for (size_t k = 0; k < n_train; k++) order[k] = k;
+
+    // SGD con momento sobre el error cuadrático de y / scale.
+    evalnet_t vel;
+    memset(&vel, 0, sizeof(vel));
+    const float momentum = 0.9f;
+    const int batch = 32;
+    for (int ep = 0; ep < o->epochs; ep++) {
+        float lr = 0.01f * (1.0f - (float)ep / (float)o->epochs) + 0.0005f;
+        for (size_t k = n_train - 1; k > 0; k--) {
+            size_t r = sim_rng_next(&rng) % (k + 1);
+            size_t t = order[k];
+            order[k] = order[r];
+            order[r] = t;
+        }
+        for (size_t b0 = 0; b0 < n_train; b0 += batch) {
+            size_t b1 = b0 + batch < n_train ? b0 + batch : n_train;
+            evalnet_t grad;
+            memset(&grad, 0, sizeof(grad));
+            for (size_t k = b0; k < b1; k++) {
+                const sample_t *e = &s->v[order[k]];
+                float x[EVALNET_INPUTS], h[EVALNET_HIDDEN];
+                for (int i = 0; i < EVALNET_INPUTS; i++) x[i] = (e->f[i] - net->mean[i]) * net->inv_std[i];
+                float err = forward(net, x, h) - e->y / net->scale;
+                grad.b2 += err;
+                for (int j = 0; j < EVALNET_HIDDEN; j++) {
+                    grad.w2[j] += err * h[j];
+                    if (h[j] <= 0.0f) continue;
+                    float gh = err * net->w2[j];
+                    grad.b1[j] += gh;
+                    for (int i = 0; i < EVALNET_INPUTS; i++) grad.w1[i][j] += gh * x[i];
+                }
+            }
+            float step = lr / (float)(b1 - b0);
+            vel.b2 = momentum * vel.b2 - step * grad.b2;
+            net->b2 += vel.b2;
+            for (int j = 0; j < EVALNET_HIDDEN; j++) {
+                vel.w2[j] = momentum * vel.w2[j] - step * grad.w2[j];
+                net->w2[j] += vel.w2[j];
+                vel.b1[j] = momentum * vel.b1[j] - step * grad.b1[j];
+                net->b1[j] += vel.b1[j];
+                for (int i = 0; i < EVALNET_INPUTS; i++) {
+                    vel.w1[i][j] = momentum * vel.w1[i][j] - step * grad.w1[i][j];
+                    net->w1[i][j] += vel.w1[i][j];
+                }
+            }
+        }
+        if ((ep + 1) % 5 == 0 || ep + 1 == o->epochs) {
+            printf("época %3d  rmse entrenamiento=%.2f  validación=%.2f  (media constante: %.2f)\n", ep + 1,
+                   rmse(net, s->v, 0, n_train), rmse(net, s->v, n_train, s->n), base);
+        }
+    }
+    free(order);
+}
+
+int main(int argc, char *argv[]) {
+    train_opts_t o = { .width = 10, .height = 10, .players = 2, .games = 100, .sims = 300,
+                       .epsilon = 0.1, .epochs = 40, .seed = 1, .input = NULL, .out = "eval.bin" };
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:g:S:x:e:s:i:o:")) != -1) {
+        switch (opt) {
+            case 'w': o.width = atoi(optarg); break;
+            case 'h': o.height = atoi(optarg); break;
+            case 'n': o.players = atoi(optarg); break;
+            case 'g': o.games = atoi(optarg); break;
+            case 'S': o.sims = atoi(optarg); break;
+            case 'x': o.epsilon = atof(optarg); break;
+            case 'e': o.epochs = atoi(optarg); break;
+            case 's': o.seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'i': o.input = optarg; break;
+            case 'o': o.out = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-w ancho] [-h alto] [-n jugadores] [-g partidas] [-S sims] [-x epsilon] [-e épocas] [-s semilla] [-i muestras] [-o salida]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (o.width <= 0 || o.height <= 0 || o.players < 2 || o.players > MAX_PLAYERS || o.games <= 0 || o.epochs <= 0) {
+        fprintf(stderr, "Parámetros inválidos\n");
+        return EXIT_FAILURE;
+    }
+    // La partida de entrenamiento usa siempre playouts, aunque haya una red cargada.
+    unsetenv("CHOMP_EVAL");
+
+    samples_t s = {0};
+    int got = o.input ? load_samples(&o, &s) : self_play(&o, &s);
+    if (got == -1 || s.n == 0 || o.players < 2) {
+        fprintf(stderr, "evaltrain: no hay muestras para entrenar\n");
+        free(s.v);
+        return EXIT_FAILURE;
+    }
+    printf("%zu muestras de %d partidas %dx%d, inferencia %s\n", s.n, o.games, o.width, o.height, evalnet_isa());
+
+    evalnet_t *net = aligned_alloc(32, sizeof(evalnet_t));
+    if (!net) {
+        perror("aligned_alloc");
+        free(s.v);
+        return EXIT_FAILURE;
+    }
+    train(&o, &s, net);
+    int rc = EXIT_SUCCESS;
+    if (evalnet_save(net, o.out) == -1) {
+        perror(o.out);
+        rc = EXIT_FAILURE;
+    } else {
+        printf("pesos en %s\n", o.out);
+    }
+    free(net);
+    free(s.v);
+    return rc;
+}
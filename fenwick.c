@@ -0,0 +1,62 @@
+#include "fenwick.h"
+#include <string.h>
+
+void fenwick2d_init(fenwick2d_t *f, int width, int height, uint32_t *storage) {
+    f->width = width;
+    f->height = height;
+    f->tree = storage;
+    memset(storage, 0, fenwick2d_bytes(width, height));
+}
+
+void fenwick2d_build(fenwick2d_t *f, const int *board) {
+    int w = f->width, h = f->height, stride = w + 1;
+    uint32_t *t = f->tree;
+    memset(t, 0, fenwick2d_bytes(w, h));
+    for (int y = 1; y <= h; y++) {
+        const int *row = board + (size_t)(y - 1) * w;
+        for (int x = 1; x <= w; x++) t[(size_t)y * stride + x] = row[x - 1] > 0 ? (uint32_t)row[x - 1] : 0u;
+    }
+    // Construcción lineal separable: primero cada fila, después cada columna.
+    for (int y = 1; y <= h; y++) {
+        uint32_t *row = t + (size_t)y * stride;
+        for (int x = 1; x <= w; x++) {
+            int up = x + (x & -x);
+            if (up <= w) row[up] += row[x];
+        }
+    }
+    for (int y = 1; y <= h; y++) {
+        int up = y + (y & -y);
+        if (up > h) continue;
+        uint32_t *src = t + (size_t)y * stride;
+        uint32_t *dst = t + (size_t)up * stride;
+        for (int x = 1; x <= w; x++) dst[x] += src[x];
+    }
+}
+
+void fenwick2d_add(fenwick2d_t *f, int x, int y, int delta) {
+    int stride = f->width + 1;
+    for (int i = y + 1; i <= f->height; i += i & -i) {
+        uint32_t *row = f->tree + (size_t)i * stride;
+        for (int j = x + 1; j <= f->width; j += j & -j) row[j] += (uint32_t)delta;
+    }
+}
+
+// Prefijo [0, x) x [0, y).
+static uint32_t prefix(const fenwick2d_t *f, int x, int y) {
+    int stride = f->width + 1;
+    uint32_t s = 0;
+    for (int i = y; i > 0; i -= i & -i) {
+        const uint32_t *row = f->tree + (size_t)i * stride;
+        for (int j = x; j > 0; j -= j & -j) s += row[j];
+    }
+    return s;
+}
+
+unsigned int fenwick2d_rect(const fenwick2d_t *f, int x0, int y0, int x1, int y1) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= f->width) x1 = f->width - 1;
+    if (y1 >= f->height) y1 = f->height - 1;
+    if (x0 > x1 || y0 > y1) return 0;
+    return prefix(f, x1 + 1, y1 + 1) - prefix(f, x0, y1 + 1) - prefix(f, x1 + 1, y0) + prefix(f, x0, y0);
+}
@@ -0,0 +1,41 @@
+#ifndef FENWICK_H
+#define FENWICK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Árbol de Fenwick 2D sobre las recompensas que quedan en el tablero (las
+// celdas tomadas valen 0). Tomar una celda es un fenwick2d_add en
+// O(log ancho · log alto) y la suma de cualquier rectángulo sale en el mismo
+// orden, en vez de recorrer sus celdas.
+//
+// Los nodos son uint32_t: con lados de hasta SIM_MAX_SIDE la suma total puede
+// pasar de INT_MAX, y la aritmética módulo 2^32 deja exacto todo resultado que
+// entre en 32 bits sin signo, aunque los parciales den la vuelta.
+typedef struct {
+    int width;
+    int height;
+    uint32_t *tree;   // (width + 1) * (height + 1), base 1
+} fenwick2d_t;
+
+static inline size_t fenwick2d_bytes(int width, int height) {
+    return sizeof(uint32_t) * (size_t)(width + 1) * (size_t)(height + 1);
+}
+
+// storage de fenwick2d_bytes(width, height) bytes (lo sigue siendo del llamador).
+void fenwick2d_init(fenwick2d_t *f, int width, int height, uint32_t *storage);
+
+// Reconstruye desde un tablero en O(celdas).
+void fenwick2d_build(fenwick2d_t *f, const int *board);
+
+void fenwick2d_add(fenwick2d_t *f, int x, int y, int delta);
+
+// Suma del rectángulo [x0, x1] x [y0, y1] (inclusive), recortado al tablero.
+unsigned int fenwick2d_rect(const fenwick2d_t *f, int x0, int y0, int x1, int y1);
+
+// Recompensa libre a distancia de Chebyshev <= r de (x, y), incluida la celda.
+static inline unsigned int fenwick2d_around(const fenwick2d_t *f, int x, int y, int r) {
+    return fenwick2d_rect(f, x - r, y - r, x + r, y + r);
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include "game.h"
+
+size_t game_state_size(int width, int height) {
+    return sizeof(game_state_t) + (size_t)width * height * sizeof(int);
+}
+
+void game_init_board(game_state_t *gs, int seed) {
+    srand(seed);
+    for (int i = 0; i < gs->height; i++) {
+        for (int j = 0; j < gs->width; j++) {
+            gs->board[i * gs->width + j] = (rand() % 9) + 1;
+        }
+    }
+}
+
+void game_init_board_r(game_state_t *gs, unsigned int *seedp) {
+    for (int i = 0; i < gs->height; i++) {
+        for (int j = 0; j < gs->width; j++) {
+            gs->board[i * gs->width + j] = (rand_r(seedp) % 9) + 1;
+        }
+    }
+}
+
+void game_place_players(game_state_t *gs) {
+    int positions[MAX_PLAYERS][2] = {
+        {0, 0},
+        {0, gs->width - 1},
+        {gs->height - 1, 0},
+        {gs->height - 1, gs->width - 1},
+        {gs->height / 2, gs->width / 2},
+        {0, gs->width / 2},
+        {gs->height - 1, gs->width / 2},
+        {gs->height / 2, 0},
+        {gs->height / 2, gs->width - 1}
+    };
+
+    for (unsigned int i = 0; i < gs->player_count; i++) {
+        gs->players[i].x = positions[i][1];
+        gs->players[i].y = positions[i][0];
+        gs->board[positions[i][0] * gs->width + positions[i][1]] = -(i+1);
+    }
+}
+
+bool game_is_valid_move_locked(const game_state_t *gs, int player_id, direction_t direction) {
+    int new_x, new_y;
+    game_target_from_dir(gs->players[player_id].x, gs->players[player_id].y, direction, &new_x, &new_y);
+
+    if (new_x < 0 || new_x >= gs->width || new_y < 0 || new_y >= gs->height) {
+        return false;
+    }
+
+    int cell_value = gs->board[new_y * gs->width + new_x];
+    if (cell_value <= 0) {
+        return false;
+    }
+
+    return true;
+}
+
+int game_apply_move_locked(game_state_t *gs, int player_id, direction_t direction) {
+    int new_x, new_y;
+    game_target_from_dir(gs->players[player_id].x, gs->players[player_id].y, direction, &new_x, &new_y);
+
+    int reward = gs->board[new_y * gs->width + new_x];
+    gs->players[player_id].score += reward;
+    gs->board[new_y * gs->width + new_x] = -(player_id+1);
+    gs->players[player_id].x = new_x;
+    gs->players[player_id].y = new_y;
+    gs->players[player_id].valid_moves++;
+    return reward;
+}
+
+bool game_any_player_has_valid_move_locked(const game_state_t *gs) {
+    for (unsigned int i = 0; i < gs->player_count; i++) {
+        if (gs->players[i].blocked) continue;
+        for (int d = 0; d < 8; d++) {
+            if (game_is_valid_move_locked(gs, i, (direction_t)d)) return true;
+        }
+    }
+    return false;
+}
+
+int game_pick_winner(const game_state_t *gs) {
+    int winner = -1;
+    unsigned int max_score = 0;
+    unsigned int min_valid_moves = 99999;
+    unsigned int min_invalid_moves = 99999;
+    for (unsigned int i = 0; i < gs->player_count; i++) {
+        if (gs->players[i].score > max_score) {
+            max_score = gs->players[i].score;
+            winner = i;
+            min_valid_moves = gs->players[i].valid_moves;
+            min_invalid_moves = gs->players[i].invalid_moves;
+        } else if (gs->players[i].score == max_score) {
+            if (gs->players[i].valid_moves < min_valid_moves) {
+                winner = i;
+                min_valid_moves = gs->players[i].valid_moves;
+                min_invalid_moves = gs->players[i].invalid_moves;
+            } else if (gs->players[i].valid_moves == min_valid_moves) {
+                if (gs->players[i].invalid_moves < min_invalid_moves) {
+                    winner = i;
+                    min_invalid_moves = gs->players[i].invalid_moves;
+                }
+            }
+        }
+    }
+    return winner;
+}
+
+int game_play_local(game_state_t *gs, int width, int height, int player_count, unsigned int seed,
+                    const game_local_hooks_t *hooks) {
+    gs->width = width;
+    gs->height = height;
+    gs->player_count = player_count;
+    gs->game_over = false;
+    for (int i = 0; i < player_count; i++) {
+        memset(&gs->players[i], 0, sizeof(player_t));
+        snprintf(gs->players[i].name, sizeof(gs->players[i].name), "Player%d", (unsigned char)(i + 1));
+    }
+    game_init_board_r(gs, &seed);
+    game_place_players(gs);
+    if (hooks->on_start) hooks->on_start(hooks->ctx, gs);
+
+    int rc = 0;
+    while (rc == 0 && game_any_player_has_valid_move_locked(gs)) {
+        bool any_valid = false;
+        for (int i = 0; i < player_count && rc == 0; i++) {
+            if (gs->players[i].blocked) continue;
+            int move = hooks->decide(hooks->ctx, gs, i);
+            if (move == -1) {
+                gs->players[i].blocked = true;
+            } else if (move >= 0 && move <= 7 && game_is_valid_move_locked(gs, i, (direction_t)move)) {
+                game_apply_move_locked(gs, i, (direction_t)move);
+                any_valid = true;
+                if (hooks->on_move) rc = hooks->on_move(hooks->ctx, gs, i, move);
+            } else {
+                gs->players[i].invalid_moves++;
+            }
+        }
+        // Equivalente al timeout del master: una ronda completa sin movimientos válidos termina la partida.
+        if (!any_valid) break;
+    }
+    gs->game_over = true;
+    return rc;
+}
@@ -0,0 +1,54 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "common.h"
+
+// Reglas del juego compartidas por el master y los modos en proceso.
+// Las funciones *_locked asumen que el llamador ya tiene acceso exclusivo al estado.
+
+static inline void game_target_from_dir(int x, int y, int d, int *tx, int *ty) {
+    switch (d) {
+        case UP:         y--; break;
+        case UP_RIGHT:   y--; x++; break;
+        case RIGHT:      x++; break;
+        case DOWN_RIGHT: y++; x++; break;
+        case DOWN:       y++; break;
+        case DOWN_LEFT:  y++; x--; break;
+        case LEFT:       x--; break;
+        case UP_LEFT:    y--; x--; break;
+        default: break;
+    }
+    *tx = x;
+    *ty = y;
+}
+
+size_t game_state_size(int width, int height);
+
+void game_init_board(game_state_t *gs, int seed);
+void game_init_board_r(game_state_t *gs, unsigned int *seedp);
+void game_place_players(game_state_t *gs);
+
+bool game_is_valid_move_locked(const game_state_t *gs, int player_id, direction_t direction);
+int game_apply_move_locked(game_state_t *gs, int player_id, direction_t direction);
+bool game_any_player_has_valid_move_locked(const game_state_t *gs);
+
+int game_pick_winner(const game_state_t *gs);
+
+// Partida completa sobre un estado privado (sin shm ni pipes), la que juegan
+// el modo en proceso, evaltrain, selfplay y sweep. Por rondas, en orden de
+// índice; como en el máster una jugada inválida sólo suma invalid_moves.
+// decide devuelve 0..7, o -1 si el jugador no tiene jugadas (queda bloqueado).
+// on_start, opcional, ve el tablero inicial con los jugadores ya ubicados;
+// on_move, opcional, se llama después de cada jugada válida; -1 corta la partida.
+typedef struct {
+    int (*decide)(void *ctx, const game_state_t *gs, int player);
+    void (*on_start)(void *ctx, const game_state_t *gs);
+    int (*on_move)(void *ctx, const game_state_t *gs, int player, int move);
+    void *ctx;
+} game_local_hooks_t;
+
+// gs tiene que tener lugar para width * height celdas. 0 al terminar, -1 si on_move cortó.
+int game_play_local(game_state_t *gs, int width, int height, int player_count, unsigned int seed,
+                    const game_local_hooks_t *hooks);
+
+#endif
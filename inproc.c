@@ -0,0 +1,186 @@
+#include "inproc.h"
+#include "game.h"
+#include <dlfcn.h>
+#include <pthread.h>
+
+typedef struct {
+    const inproc_opts_t *opts;
+    const strategy_plugin_t **plugins;
+    int player_count;
+    int first_game;
+    int game_count;
+    unsigned long wins[MAX_PLAYERS];
+    unsigned long ties;
+    unsigned long long moves;
+    int failed;
+} inproc_worker_t;
+
+bool inproc_is_plugin_path(const char *path) {
+    size_t len = strlen(path);
+    return len > 3 && strcmp(path + len - 3, ".so") == 0;
+}
+
+typedef struct {
+    inproc_worker_t *w;
+    void **ctxs;
+    sim_player_t *sim_players;
+} inproc_game_t;
+
+static int inproc_decide(void *arg, const game_state_t *gs, int i) {
+    inproc_game_t *g = arg;
+    strategy_players_from_state(g->sim_players, gs->players, gs->player_count);
+    strategy_state_t st = {
+        .width = gs->width,
+        .height = gs->height,
+        .player_count = (int)gs->player_count,
+        .my_index = i,
+        .board = gs->board,
+        .players = g->sim_players
+    };
+    return g->w->plugins[i]->decide(g->ctxs[i], &st, &g->w->opts->budget);
+}
+
+static int inproc_on_move(void *arg, const game_state_t *gs, int i, int move) {
+    (void)gs;
+    (void)i;
+    (void)move;
+    ((inproc_game_t *)arg)->w->moves++;
+    return 0;
+}
+
+static int play_one_game(inproc_worker_t *w, game_state_t *gs, void **ctxs, sim_player_t *sim_players, unsigned int game_seed) {
+    inproc_game_t g = { .w = w, .ctxs = ctxs, .sim_players = sim_players };
+    game_local_hooks_t hooks = { .decide = inproc_decide, .on_move = inproc_on_move, .ctx = &g };
+    game_play_local(gs, w->opts->width, w->opts->height, w->player_count, game_seed, &hooks);
+    return game_pick_winner(gs);
+}
+
+static void *inproc_worker(void *arg) {
+    inproc_worker_t *w = arg;
+    int width = w->opts->width;
+    int height = w->opts->height;
+
+    game_state_t *gs = malloc(game_state_size(width, height));
+    sim_player_t sim_players[MAX_PLAYERS];
+    void *ctxs[MAX_PLAYERS] = {0};
+    if (!gs) {
+        w->failed = 1;
+        return NULL;
+    }
+    for (int i = 0; i < w->player_count; i++) {
+        unsigned int seed = (unsigned int)(w->opts->seed * 31 + w->first_game * MAX_PLAYERS + i + 1);
+        ctxs[i] = w->plugins[i]->create(width, height, w->player_count, seed);
+        if (!ctxs[i]) {
+            w->failed = 1;
+            goto out;
+        }
+    }
+
+    for (int g = 0; g < w->game_count; g++) {
+        int winner = play_one_game(w, gs, ctxs, sim_players, (unsigned int)(w->opts->seed + w->first_game + g));
+        if (winner >= 0) w->wins[winner]++;
+        else w->ties++;
+    }
+
+out:
+    for (int i = 0; i < w->player_count; i++) {
+        if (ctxs[i]) w->plugins[i]->destroy(ctxs[i]);
+    }
+    free(gs);
+    return NULL;
+}
+
+int inproc_run(char **plugin_paths, int player_count, const inproc_opts_t *opts) {
+    void *handles[MAX_PLAYERS] = {0};
+    const strategy_plugin_t *plugins[MAX_PLAYERS];
+    int rc = -1;
+
+    for (int i = 0; i < player_count; i++) {
+        // dlopen devuelve el mismo handle para el mismo .so; cada asiento tiene su propio contexto.
+        handles[i] = dlopen(plugin_paths[i], RTLD_NOW | RTLD_LOCAL);
+        if (!handles[i]) {
+            fprintf(stderr, "dlopen %s: %s\n", plugin_paths[i], dlerror());
+            goto out;
+        }
+        plugins[i] = dlsym(handles[i], STRATEGY_PLUGIN_SYMBOL);
+        if (!plugins[i]) {
+            fprintf(stderr, "dlsym %s: %s\n", plugin_paths[i], dlerror());
+            goto out;
+        }
+        if (plugins[i]->abi_version != STRATEGY_ABI_VERSION) {
+            fprintf(stderr, "%s: ABI %d incompatible (se esperaba %d)\n",
+                    plugin_paths[i], plugins[i]->abi_version, STRATEGY_ABI_VERSION);
+            goto out;
+        }
+    }
+
+    int threads = opts->threads;
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+    if (threads > opts->games) threads = opts->games;
+
+    inproc_worker_t *workers = calloc(threads, sizeof(inproc_worker_t));
+    pthread_t *tids = calloc(threads, sizeof(pthread_t));
+    if (!workers || !tids) {
+        perror("calloc");
+        free(workers);
+        free(tids);
+        goto out;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    int next_game = 0;
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t].opts = opts;
+        workers[t].plugins = plugins;
+        workers[t].player_count = player_count;
+        workers[t].first_game = next_game;
+        workers[t].game_count = opts->games / threads + (t < opts->games % threads ? 1 : 0);
+        next_game += workers[t].game_count;
+        if (pthread_create(&tids[t], NULL, inproc_worker, &workers[t]) != 0) {
+            perror("pthread_create");
+            break;
+        }
+        started++;
+    }
+
+    unsigned long wins[MAX_PLAYERS] = {0};
+    unsigned long ties = 0;
+    unsigned long long moves = 0;
+    int played = 0;
+    int failed = started < threads;
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+        if (workers[t].failed) {
+            failed = 1;
+            continue;
+        }
+        for (int i = 0; i < player_count; i++) wins[i] += workers[t].wins[i];
+        ties += workers[t].ties;
+        moves += workers[t].moves;
+        played += workers[t].game_count;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("Partidas: %d en %.3f s (%.1f partidas/s, %.0f movimientos/s, %d hilos)\n",
+           played, secs, secs > 0 ? played / secs : 0.0, secs > 0 ? moves / secs : 0.0, started);
+    for (int i = 0; i < player_count; i++) {
+        printf("  Player%d (%s, %s): %lu victorias\n", i + 1, plugin_paths[i], plugins[i]->name, wins[i]);
+    }
+    if (ties) printf("  Empates: %lu\n", ties);
+
+    free(workers);
+    free(tids);
+    rc = failed ? -1 : 0;
+
+out:
+    for (int i = 0; i < player_count; i++) {
+        if (handles[i]) dlclose(handles[i]);
+    }
+    return rc;
+}
@@ -0,0 +1,21 @@
+#ifndef INPROC_H
+#define INPROC_H
+
+#include "strategy.h"
+
+// Modo en proceso: las estrategias se cargan como .so y se juegan partidas
+// completas sobre tableros privados desde hilos trabajadores, sin shm ni pipes.
+typedef struct {
+    int width;
+    int height;
+    int seed;
+    int games;
+    int threads;
+    strategy_budget_t budget;
+} inproc_opts_t;
+
+bool inproc_is_plugin_path(const char *path);
+
+int inproc_run(char **plugin_paths, int player_count, const inproc_opts_t *opts);
+
+#endif
@@ -0,0 +1,130 @@
+#include "lz.h"
+#include <string.h>
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 16
+// Las últimas posiciones van siempre como literales (no hay 4 bytes para el hash).
+#define LZ_TAIL 8
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static uint8_t *put_len(uint8_t *op, const uint8_t *end, size_t len) {
+    while (len >= 255) {
+        if (op >= end) return NULL;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= end) return NULL;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t *put_varint(uint8_t *op, const uint8_t *end, size_t v) {
+    do {
+        if (op >= end) return NULL;
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        *op++ = b | (v ? 0x80 : 0);
+    } while (v);
+    return op;
+}
+
+static uint8_t *put_sequence(uint8_t *op, const uint8_t *end, const uint8_t *lit, size_t lit_len, size_t offset, size_t match_len) {
+    if (op >= end) return NULL;
+    uint8_t *token = op++;
+    size_t ml = match_len ? match_len - LZ_MIN_MATCH : 0;
+    *token = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4 | (ml >= 15 ? 15 : ml));
+    if (lit_len >= 15 && !(op = put_len(op, end, lit_len - 15))) return NULL;
+    if ((size_t)(end - op) < lit_len) return NULL;
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (!match_len) return op;
+    if (!(op = put_varint(op, end, offset))) return NULL;
+    if (ml >= 15 && !(op = put_len(op, end, ml - 15))) return NULL;
+    return op;
+}
+
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap) {
+    uint32_t table[1u << LZ_HASH_BITS];
+    memset(table, 0xFF, sizeof(table));
+    uint8_t *op = dst;
+    const uint8_t *end = dst + cap;
+    size_t anchor = 0;
+    size_t i = 0;
+    size_t limit = n > LZ_TAIL ? n - LZ_TAIL : 0;
+    while (i < limit) {
+        uint32_t v = read32(src + i);
+        uint32_t h = hash4(v);
+        uint32_t cand = table[h];
+        table[h] = (uint32_t)i;
+        if (cand == UINT32_MAX || read32(src + cand) != v) {
+            i++;
+            continue;
+        }
+        size_t len = LZ_MIN_MATCH;
+        while (i + len < n - LZ_TAIL / 2 && src[cand + len] == src[i + len]) len++;
+        if (!(op = put_sequence(op, end, src + anchor, i - anchor, i - cand, len))) return 0;
+        // Una entrada más dentro de la copia ayuda con los patrones periódicos.
+        if (i + len - 2 > i) table[hash4(read32(src + i + len - 2))] = (uint32_t)(i + len - 2);
+        i += len;
+        anchor = i;
+    }
+    if (!(op = put_sequence(op, end, src + anchor, n - anchor, 0, 0))) return 0;
+    return (size_t)(op - dst);
+}
+
+static int get_len(const uint8_t **ip, const uint8_t *end, size_t *len) {
+    uint8_t b;
+    do {
+        if (*ip >= end) return -1;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 0;
+}
+
+int lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t out_n) {
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + n;
+    size_t o = 0;
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && get_len(&ip, iend, &lit) == -1) return -1;
+        if ((size_t)(iend - ip) < lit || out_n - o < lit) return -1;
+        memcpy(dst + o, ip, lit);
+        ip += lit;
+        o += lit;
+        if (ip == iend) break;
+        size_t offset = 0;
+        int shift = 0;
+        uint8_t b;
+        do {
+            if (ip >= iend || shift > 56) return -1;
+            b = *ip++;
+            offset |= (size_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        size_t len = token & 15;
+        if (len == 15 && get_len(&ip, iend, &len) == -1) return -1;
+        len += LZ_MIN_MATCH;
+        if (offset == 0 || offset > o || out_n - o < len) return -1;
+        // Si se solapa (offset < len) se copia de a offset bytes: cada tramo
+        // ya está escrito cuando le toca ser origen del siguiente.
+        while (len > 0) {
+            size_t chunk = offset < len ? offset : len;
+            memcpy(dst + o, dst + o - offset, chunk);
+            o += chunk;
+            len -= chunk;
+        }
+    }
+    return o == out_n ? 0 : -1;
+}
@@ -0,0 +1,24 @@
+#ifndef LZ_H
+#define LZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Compresor LZ77 de bloques, estilo LZ4: secuencias de literales + copia con
+// un token de 4+4 bits, longitudes extendidas de a 255 y distancias en
+// varint (sin ventana fija, así una columna de tableros encuentra el tablero
+// anterior aunque ocupe más de 64 KiB). Greedy con una tabla hash de 4 bytes:
+// prioriza velocidad sobre ratio.
+
+// Peor caso de lz_compress para n bytes.
+static inline size_t lz_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+// Devuelve los bytes escritos en dst, o 0 si no entran en cap.
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap);
+
+// Descomprime exactamente out_n bytes; -1 si la entrada está corrupta.
+int lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t out_n);
+
+#endif
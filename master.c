@@ -1,5 +1,12 @@
 #include "common.h"
 #include "shm_manager.h"
+#include "game.h"
+#include "inproc.h"
+#include "referee.h"
+#include "spawn.h"
+#include "trace.h"
+#include "metrics.h"
+#include "telemetry.h"
 #include <getopt.h>
 #include <errno.h>
 #include <signal.h>
@@ -29,40 +36,14 @@ static void destroy_sync_sems(void) {
     if (game_sync == NULL) return;
 
 
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-      
-        sem_post(&game_sync->player_mutex[i]);
-    }
-
-    sem_post(&game_sync->master_to_view);
-    sem_post(&game_sync->view_to_master);
-
-    if (sem_destroy(&game_sync->master_to_view) == -1) {
-        perror("sem_destroy master_to_view");
-    }
-    if (sem_destroy(&game_sync->view_to_master) == -1) {
-        perror("sem_destroy view_to_master");
-    }
-    if (sem_destroy(&game_sync->master_mutex) == -1) {
-        perror("sem_destroy master_mutex");
-    }
-    if (sem_destroy(&game_sync->state_mutex) == -1) {
-        perror("sem_destroy state_mutex");
-    }
-    if (sem_destroy(&game_sync->reader_count_mutex) == -1) {
-        perror("sem_destroy reader_count_mutex");
-    }
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (sem_destroy(&game_sync->player_mutex[i]) == -1) {
-            perror("sem_destroy player_mutex");
-        }
-    }
+    referee_sync_destroy(game_sync);
 
     sync_sems_destroyed = 1;
 }
 
 void cleanup() {
     destroy_sync_sems();
+    telemetry_destroy();
 
     if (state_mgr != NULL) {
         shm_manager_destroy(state_mgr);
@@ -86,97 +67,6 @@ void signal_handler(int sig) {
     _exit(EXIT_FAILURE);
 }
 
-void initialize_board(int seed) {
-    srand(seed);
-    for (int i = 0; i < game_state->height; i++) {
-        for (int j = 0; j < game_state->width; j++) {
-            game_state->board[i * game_state->width + j] = (rand() % 9) + 1;
-        }
-    }
-}
-
-void place_players() {
-    int positions[MAX_PLAYERS][2] = {
-        {0, 0},
-        {0, game_state->width - 1},
-        {game_state->height - 1, 0},
-        {game_state->height - 1, game_state->width - 1},
-        {game_state->height / 2, game_state->width / 2},
-        {0, game_state->width / 2},
-        {game_state->height - 1, game_state->width / 2},
-        {game_state->height / 2, 0},
-        {game_state->height / 2, game_state->width - 1}
-    };
-
-    for (unsigned int i = 0; i < game_state->player_count; i++) {
-        game_state->players[i].x = positions[i][1];
-        game_state->players[i].y = positions[i][0];
-        game_state->board[positions[i][0] * game_state->width + positions[i][1]] = -(i+1);
-    }
-}
-
-bool is_valid_move_locked(int player_id, direction_t direction) {
-    int x = game_state->players[player_id].x;
-    int y = game_state->players[player_id].y;
-    int new_x = x, new_y = y;
-
-    switch (direction) {
-        case UP: new_y--; break;
-        case UP_RIGHT: new_y--; new_x++; break;
-        case RIGHT: new_x++; break;
-        case DOWN_RIGHT: new_y++; new_x++; break;
-        case DOWN: new_y++; break;
-        case DOWN_LEFT: new_y++; new_x--; break;
-        case LEFT: new_x--; break;
-        case UP_LEFT: new_y--; new_x--; break;
-    }
-
-    if (new_x < 0 || new_x >= game_state->width || new_y < 0 || new_y >= game_state->height) {
-        return false;
-    }
-
-    int cell_value = game_state->board[new_y * game_state->width + new_x];
-    if (cell_value <= 0) {
-        return false;
-    }
-
-    return true;
-}
-
-void apply_move_locked(int player_id, direction_t direction) {
-    int x = game_state->players[player_id].x;
-    int y = game_state->players[player_id].y;
-    int new_x = x, new_y = y;
-
-    switch (direction) {
-        case UP: new_y--; break;
-        case UP_RIGHT: new_y--; new_x++; break;
-        case RIGHT: new_x++; break;
-        case DOWN_RIGHT: new_y++; new_x++; break;
-        case DOWN: new_y++; break;
-        case DOWN_LEFT: new_y++; new_x--; break;
-        case LEFT: new_x--; break;
-        case UP_LEFT: new_y--; new_x--; break;
-    }
-
-    int reward = game_state->board[new_y * game_state->width + new_x];
-    game_state->players[player_id].score += reward;
-    game_state->board[new_y * game_state->width + new_x] = -(player_id+1);
-    game_state->players[player_id].x = new_x;
-    game_state->players[player_id].y = new_y;
-    game_state->players[player_id].valid_moves++;
-}
-
-bool any_player_has_valid_move_locked() {
-    for (unsigned int i = 0; i < game_state->player_count; i++) {
-        if (game_state->players[i].blocked) continue;
-        for (int d = 0; d < 8; d++) {
-            if (is_valid_move_locked(i, (direction_t)d)) return true;
-        }
-    }
-    return false;
-}
-
 int main(int argc, char *argv[]) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
@@ -189,8 +79,19 @@ int main(int argc, char *argv[]) {
     char *view_path = NULL;
     char *player_paths[MAX_PLAYERS];
     int player_count = 0;
-
-    struct timeval last_valid_move_time, current_time;
+    int games = 1;
+    int threads = 0;
+    bool show_spawn_times = false;
+    bool show_metrics = false;
+    char *metrics_json_path = NULL;
+    char *dump_dir = NULL;
+    int dump_moves[64];
+    int dump_move_count = 0;
+    int dump_every = 0;
+    int move_budget_ms = 0;
+    int bank_ms = 0;
+    bool overdue_blocks = false;
+    int referee_threads = 0;
 
     for (int i = 0; i < MAX_PLAYERS; i++) {
         player_pipes[i][PIPE_READ] = -1;
@@ -200,7 +101,7 @@ int main(int argc, char *argv[]) {
     int opt;
     extern char *optarg;
     extern int optind;
-    while ((opt = getopt(argc, argv, "w:h:d:t:s:v:p:")) != -1) {
+    while ((opt = getopt(argc, argv, "w:h:d:t:s:v:p:g:j:lmM:P:K:b:B:O:R:")) != -1) {
         switch (opt) {
             case 'w': width = atoi(optarg); break;
             case 'h': height = atoi(optarg); break;
@@ -208,6 +109,26 @@ int main(int argc, char *argv[]) {
             case 't': timeout_sec = atoi(optarg); break;
             case 's': seed = atoi(optarg); break;
             case 'v': view_path = optarg; break;
+            case 'g': games = atoi(optarg); break;
+            case 'j': threads = atoi(optarg); break;
+            case 'l': show_spawn_times = true; break;
+            case 'm': show_metrics = true; break;
+            case 'M': metrics_json_path = optarg; break;
+            case 'P': dump_dir = optarg; break;
+            case 'K':
+                if (optarg[0] == '+') {
+                    dump_every = atoi(optarg + 1);
+                } else {
+                    char *save = NULL;
+                    for (char *tok = strtok_r(optarg, ",", &save); tok && dump_move_count < 64; tok = strtok_r(NULL, ",", &save)) {
+                        dump_moves[dump_move_count++] = atoi(tok);
+                    }
+                }
+                break;
+            case 'b': move_budget_ms = atoi(optarg); break;
+            case 'B': bank_ms = atoi(optarg); break;
+            case 'O': overdue_blocks = strcmp(optarg, "block") == 0; break;
+            case 'R': referee_threads = atoi(optarg); break;
             case 'p':
                 if (player_count < MAX_PLAYERS) {
                     player_paths[player_count++] = optarg;
@@ -216,7 +137,7 @@ int main(int argc, char *argv[]) {
                 }
                 break;
             default:
-                fprintf(stderr, "Uso: %s [-w width] [-h height] [-d delay] [-t timeout] [-s seed] [-v view] -p player1 [player2 ...]\n", argv[0]);
+                fprintf(stderr, "Uso: %s [-w width] [-h height] [-d delay] [-t timeout] [-s seed] [-v view] [-g games] [-j threads] [-l] [-m] [-M metrics.json] [-P dir_posiciones] [-K 10,20|+N] [-b ms_por_jugada] [-B ms_banco] [-O skip|block] [-R hilos_arbitro] -p player1 [player2 ...]\n", argv[0]);
                 exit(EXIT_FAILURE);
         }
     }
@@ -229,7 +150,24 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    size_t state_size = sizeof(game_state_t) + (size_t)width * height * sizeof(int);
+    bool all_plugins = true;
+    for (int i = 0; i < player_count; i++) {
+        if (!inproc_is_plugin_path(player_paths[i])) all_plugins = false;
+    }
+    if (all_plugins) {
+        if (games < 1) games = 1;
+        inproc_opts_t opts = {
+            .width = width,
+            .height = height,
+            .seed = seed,
+            .games = games,
+            .threads = threads,
+            .budget = { 0, 0 }
+        };
+        return inproc_run(player_paths, player_count, &opts) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    size_t state_size = game_state_size(width, height);
     state_mgr = shm_manager_create(SHM_GAME_STATE, state_size, 0666, 0, 0);
     if (!state_mgr) {
         perror("shm_manager_create state");
@@ -259,32 +197,28 @@ int main(int argc, char *argv[]) {
         game_state->players[i].pid = 0;
     }
 
-    initialize_board(seed);
-    place_players();
+    game_init_board(game_state, seed);
+    game_place_players(game_state);
 
-    if (sem_init(&game_sync->master_to_view, 1, 0) == -1) { perror("sem_init master_to_view"); cleanup(); exit(EXIT_FAILURE); }
-    if (sem_init(&game_sync->view_to_master, 1, 0) == -1) { perror("sem_init view_to_master"); cleanup(); exit(EXIT_FAILURE); }
-    if (sem_init(&game_sync->master_mutex, 1, 1) == -1) { perror("sem_init master_mutex"); cleanup(); exit(EXIT_FAILURE); }
-    if (sem_init(&game_sync->state_mutex, 1, 1) == -1) { perror("sem_init state_mutex"); cleanup(); exit(EXIT_FAILURE); }
-    if (sem_init(&game_sync->reader_count_mutex, 1, 1) == -1) { perror("sem_init reader_count_mutex"); cleanup(); exit(EXIT_FAILURE); }
-    game_sync->reader_count = 0;
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (sem_init(&game_sync->player_mutex[i], 1, 0) == -1) { perror("sem_init player_mutex"); cleanup(); exit(EXIT_FAILURE); }
-    }
+    if (referee_sync_init(game_sync) == -1) { cleanup(); exit(EXIT_FAILURE); }
 
-    
+    if (trace_create() == -1) { cleanup(); exit(EXIT_FAILURE); }
+    trace_attach("master");
+    if (telemetry_create(player_count) == -1) { cleanup(); exit(EXIT_FAILURE); }
+
+
+    char width_str[16], height_str[16];
+    snprintf(width_str, sizeof(width_str), "%d", width);
+    snprintf(height_str, sizeof(height_str), "%d", height);
+
+    double spawn_us = 0.0, spawn_total_us = 0.0;
     pid_t view_pid = -1;
     if (view_path != NULL) {
-        view_pid = fork();
-        if (view_pid == -1) { perror("fork view"); cleanup(); exit(EXIT_FAILURE); }
-        else if (view_pid == 0) {
-            char width_str[16], height_str[16];
-            snprintf(width_str, sizeof(width_str), "%d", width);
-            snprintf(height_str, sizeof(height_str), "%d", height);
-            execl(view_path, view_path, width_str, height_str, NULL);
-            perror("execl view");
-            _exit(EXIT_FAILURE);
-        }
+        char *view_argv[] = { view_path, width_str, height_str, NULL };
+        view_pid = spawn_process(view_path, view_argv, -1, &spawn_us);
+        if (view_pid == -1) { perror("posix_spawn view"); cleanup(); exit(EXIT_FAILURE); }
+        spawn_total_us += spawn_us;
+        if (show_spawn_times) fprintf(stderr, "spawn view: %.1f us\n", spawn_us);
     }
 
     if (view_path != NULL) {
@@ -295,198 +229,49 @@ int main(int argc, char *argv[]) {
     
     for (int i = 0; i < player_count; i++) {
         if (pipe(player_pipes[i]) == -1) { perror("pipe"); cleanup(); exit(EXIT_FAILURE); }
-    }
-
-   
-    int max_fd = -1;
-    for (int i = 0; i < player_count; i++) {
-        pid_t pid = fork();
-        if (pid == -1) { perror("fork"); cleanup(); exit(EXIT_FAILURE); }
-        else if (pid == 0) {
-          
-            close(player_pipes[i][PIPE_READ]);
-            dup2(player_pipes[i][PIPE_WRITE], STDOUT_FILENO);
-            close(player_pipes[i][PIPE_WRITE]);
-
-            char width_str[16], height_str[16];
-            snprintf(width_str, sizeof(width_str), "%d", width);
-            snprintf(height_str, sizeof(height_str), "%d", height);
-
-            execl(player_paths[i], player_paths[i], width_str, height_str, NULL);
-            perror("execl");
-            _exit(EXIT_FAILURE);
-        } else {
-        
-            close(player_pipes[i][PIPE_WRITE]);
-            game_state->players[i].pid = pid;
-            if (player_pipes[i][PIPE_READ] > max_fd) max_fd = player_pipes[i][PIPE_READ];
+        if (set_cloexec(player_pipes[i][PIPE_READ]) == -1 || set_cloexec(player_pipes[i][PIPE_WRITE]) == -1) {
+            perror("fcntl FD_CLOEXEC"); cleanup(); exit(EXIT_FAILURE);
         }
     }
 
-    gettimeofday(&last_valid_move_time, NULL);
-
-    
-    for (int i = 0; i < player_count; i++) {
-        if (!game_state->players[i].blocked) sem_post(&game_sync->player_mutex[i]);
-    }
-
-    while (!game_state->game_over) {
-        fd_set rfds;
-        FD_ZERO(&rfds);
-        int local_max_fd = -1;
-        for (int i = 0; i < player_count; i++) {
-            if (player_pipes[i][PIPE_READ] != -1 && !game_state->players[i].blocked) {
-                FD_SET(player_pipes[i][PIPE_READ], &rfds);
-                if (player_pipes[i][PIPE_READ] > local_max_fd) local_max_fd = player_pipes[i][PIPE_READ];
-            }
-        }
-
-        if (local_max_fd == -1) break; 
-
-        struct timeval timeout;
-        timeout.tv_sec = delay_ms / 1000;
-        timeout.tv_usec = (delay_ms % 1000) * 1000;
-
-        int ready = select(local_max_fd + 1, &rfds, NULL, NULL, &timeout);
-        if (ready == -1) {
-            if (errno == EINTR) continue;
-            perror("select");
-            break;
-        }
-
-        if (ready > 0) {
-            for (int i = 0; i < player_count; i++) {
-                if (player_pipes[i][PIPE_READ] == -1) continue;
-                if (!FD_ISSET(player_pipes[i][PIPE_READ], &rfds)) continue;
-
-                unsigned char move;
-                ssize_t bytes_read = read(player_pipes[i][PIPE_READ], &move, 1);
-                if (bytes_read == 0) {
-                    if (sem_wait(&game_sync->master_mutex) == -1) {
-                        perror("sem_wait master_mutex");
-                        break;
-                    }
-                    if (sem_wait(&game_sync->state_mutex) == -1) {
-                        perror("sem_wait state_mutex");
-                        sem_post(&game_sync->master_mutex);
-                        break;
-                    }
-                    game_state->players[i].blocked = true;
-                    close(player_pipes[i][PIPE_READ]);
-                    player_pipes[i][PIPE_READ] = -1;
-                    sem_post(&game_sync->state_mutex);
-                    sem_post(&game_sync->master_mutex);
-                } else if (bytes_read == 1) {
-                    if (sem_wait(&game_sync->master_mutex) == -1) {
-                        perror("sem_wait master_mutex");
-                        break;
-                    }
-                    if (sem_wait(&game_sync->state_mutex) == -1) {
-                        perror("sem_wait state_mutex");
-                        sem_post(&game_sync->master_mutex);
-                        break;
-                    }
-
-                    if (move > 7) {
-                        game_state->players[i].invalid_moves++;
-                    } else if (is_valid_move_locked(i, (direction_t)move)) {
-                        apply_move_locked(i, (direction_t)move);
-                        gettimeofday(&last_valid_move_time, NULL);
-                    } else {
-                        game_state->players[i].invalid_moves++;
-                    }
-
-                    sem_post(&game_sync->state_mutex);
-                    sem_post(&game_sync->master_mutex);
-
-                    if (view_path != NULL) {
-                        sem_post(&game_sync->master_to_view);
-                        sem_wait(&game_sync->view_to_master);
-                    }
-
-                    
-                    sem_post(&game_sync->player_mutex[i]);
-
-                    
-                    struct timespec ts = {0, delay_ms * 1000000};
-                    nanosleep(&ts, NULL);
-                }
-            }
-        } 
-
-        if (sem_wait(&game_sync->state_mutex) == -1) {
-            if (errno == EINTR) continue;
-            perror("sem_wait state_mutex (any_player check)");
-            break;
-        }
-        bool any_valid = any_player_has_valid_move_locked();
-        sem_post(&game_sync->state_mutex);
-
-        if (!any_valid) {
-            if (sem_wait(&game_sync->master_mutex) == -1) { perror("sem_wait master_mutex"); break; }
-            if (sem_wait(&game_sync->state_mutex) == -1) { perror("sem_wait state_mutex"); sem_post(&game_sync->master_mutex); break; }
-            game_state->game_over = true;
-            sem_post(&game_sync->state_mutex);
-            sem_post(&game_sync->master_mutex);
-            break;
-        }
-
-        gettimeofday(&current_time, NULL);
-        double elapsed = (current_time.tv_sec - last_valid_move_time.tv_sec) +
-                         (current_time.tv_usec - last_valid_move_time.tv_usec) / 1000000.0;
-        if (elapsed >= timeout_sec) {
-            if (sem_wait(&game_sync->master_mutex) == -1) { perror("sem_wait master_mutex"); break; }
-            if (sem_wait(&game_sync->state_mutex) == -1) { perror("sem_wait state_mutex"); sem_post(&game_sync->master_mutex); break; }
-            game_state->game_over = true;
-            sem_post(&game_sync->state_mutex);
-            sem_post(&game_sync->master_mutex);
-            break;
-        }
-
-        bool all_blocked = true;
-        if (sem_wait(&game_sync->state_mutex) == -1) {
-            if (errno == EINTR) continue;
-            perror("sem_wait state_mutex (all_blocked check)");
-            break;
-        }
-        for (int i = 0; i < player_count; i++) {
-            if (!game_state->players[i].blocked) { all_blocked = false; break; }
-        }
-        sem_post(&game_sync->state_mutex);
-
-        if (all_blocked) {
-            if (sem_wait(&game_sync->master_mutex) == -1) { perror("sem_wait master_mutex"); break; }
-            if (sem_wait(&game_sync->state_mutex) == -1) { perror("sem_wait state_mutex"); sem_post(&game_sync->master_mutex); break; }
-            game_state->game_over = true;
-            sem_post(&game_sync->state_mutex);
-            sem_post(&game_sync->master_mutex);
-            break;
-        }
-    }
-
-   
-    if (view_path != NULL) {
-        sem_post(&game_sync->master_to_view);
-        sem_wait(&game_sync->view_to_master);
-    }
-
    
-    if (sem_wait(&game_sync->master_mutex) == -1) {
-        perror("sem_wait master_mutex (final)");
-    } else {
-        if (sem_wait(&game_sync->state_mutex) == -1) {
-            perror("sem_wait state_mutex (final)");
-            sem_post(&game_sync->master_mutex);
-        } else {
-            game_state->game_over = true;
-            if (sem_post(&game_sync->state_mutex) == -1) perror("sem_post state_mutex (final)");
-            if (sem_post(&game_sync->master_mutex) == -1) perror("sem_post master_mutex (final)");
-        }
-    }
-
     for (int i = 0; i < player_count; i++) {
-        sem_post(&game_sync->player_mutex[i]);
-    }
+        char *player_argv[] = { player_paths[i], width_str, height_str, NULL };
+        pid_t pid = spawn_process(player_paths[i], player_argv, player_pipes[i][PIPE_WRITE], &spawn_us);
+        if (pid == -1) { perror("posix_spawn player"); cleanup(); exit(EXIT_FAILURE); }
+        spawn_total_us += spawn_us;
+        if (show_spawn_times) fprintf(stderr, "spawn %s: %.1f us\n", player_paths[i], spawn_us);
+
+        close(player_pipes[i][PIPE_WRITE]);
+        player_pipes[i][PIPE_WRITE] = -1;
+        game_state->players[i].pid = pid;
+    }
+    if (show_spawn_times) fprintf(stderr, "spawn total: %.1f us\n", spawn_total_us);
+
+
+    referee_t ref = {
+        .state = game_state,
+        .sync = game_sync,
+        .pipes = player_pipes,
+        .player_count = player_count,
+        .delay_ms = delay_ms,
+        .timeout_sec = timeout_sec,
+        .with_view = view_path != NULL,
+        .view_pid = view_pid,
+        .metrics_json_path = metrics_json_path,
+        .dump_dir = dump_dir,
+        .dump_moves = dump_moves,
+        .dump_move_count = dump_move_count,
+        .dump_every = (dump_dir && dump_move_count == 0 && dump_every <= 0) ? 10 : dump_every,
+        .dump_tag = seed,
+        .move_budget_ms = move_budget_ms,
+        .bank_ms = bank_ms,
+        .overdue_blocks = overdue_blocks,
+        .workers = referee_threads
+    };
+    metrics_install_sigusr1();
+    referee_run(&ref);
+    referee_finish(&ref);
 
     for (int i = 0; i < player_count; i++) {
         pid_t p = game_state->players[i].pid;
@@ -501,29 +286,12 @@ int main(int argc, char *argv[]) {
 
     destroy_sync_sems();
 
-    int winner = -1;
-    unsigned int max_score = 0;
-    unsigned int min_valid_moves = 99999;
-    unsigned int min_invalid_moves = 99999;
-    for (int i = 0; i < player_count; i++) {
-        if (game_state->players[i].score > max_score) {
-            max_score = game_state->players[i].score;
-            winner = i;
-            min_valid_moves = game_state->players[i].valid_moves;
-            min_invalid_moves = game_state->players[i].invalid_moves;
-        } else if (game_state->players[i].score == max_score) {
-            if (game_state->players[i].valid_moves < min_valid_moves) {
-                winner = i;
-                min_valid_moves = game_state->players[i].valid_moves;
-                min_invalid_moves = game_state->players[i].invalid_moves;
-            } else if (game_state->players[i].valid_moves == min_valid_moves) {
-                if (game_state->players[i].invalid_moves < min_invalid_moves) {
-                    winner = i;
-                    min_invalid_moves = game_state->players[i].invalid_moves;
-                }
-            }
-        }
-    }
+    trace_detach();
+
+    if (show_metrics) metrics_dump_text(stderr, player_count);
+    if (metrics_json_path && metrics_dump_json(metrics_json_path, player_count) == -1) perror(metrics_json_path);
+
+    int winner = game_pick_winner(game_state);
     if (winner != -1) printf("Ganador: %s con %u puntos\n", game_state->players[winner].name, game_state->players[winner].score);
     else printf("Empate\n");
 
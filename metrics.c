@@ -0,0 +1,158 @@
+#include "metrics.h"
+
+referee_metrics_t referee_metrics;
+
+static volatile sig_atomic_t dump_requested = 0;
+
+uint64_t hist_bucket_lower(int index) {
+    if (index < HIST_SUB_COUNT) return (uint64_t)index;
+    int exp = index / HIST_SUB_COUNT - 1;
+    uint64_t sub = (uint64_t)(index % HIST_SUB_COUNT);
+    return (HIST_SUB_COUNT + sub) << exp;
+}
+
+uint64_t hist_percentile(const hist_t *h, double p) {
+    if (h->count == 0) return 0;
+    uint64_t rank = (uint64_t)(p * (double)h->count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > h->count) rank = h->count;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t lo = hist_bucket_lower(i);
+            uint64_t hi = (i + 1 < HIST_BUCKETS) ? hist_bucket_lower(i + 1) : h->max;
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (mid < h->min) mid = h->min;
+            if (mid > h->max) mid = h->max;
+            return mid;
+        }
+    }
+    return h->max;
+}
+
+void hist_reset(hist_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+typedef struct {
+    char name[32];
+    const hist_t *h;
+} named_hist_t;
+
+static int collect(named_hist_t *out, int player_count) {
+    int n = 0;
+    const referee_metrics_t *m = &referee_metrics;
+    out[n++] = (named_hist_t){ "ready_to_apply", &m->ready_to_apply };
+    out[n++] = (named_hist_t){ "master_mutex_wait", &m->master_mutex_wait };
+    out[n++] = (named_hist_t){ "state_mutex_wait", &m->state_mutex_wait };
+    out[n++] = (named_hist_t){ "master_mutex_hold", &m->master_mutex_hold };
+    out[n++] = (named_hist_t){ "state_mutex_hold", &m->state_mutex_hold };
+    out[n++] = (named_hist_t){ "view_handshake", &m->view_handshake };
+    for (int i = 0; i < player_count && i < MAX_PLAYERS; i++) {
+        snprintf(out[n].name, sizeof(out[n].name), "move_interval.p%d", (unsigned char)(i + 1));
+        out[n].h = &m->move_interval[i];
+        n++;
+    }
+    for (int i = 0; i < player_count && i < MAX_PLAYERS; i++) {
+        snprintf(out[n].name, sizeof(out[n].name), "think_time.p%d", (unsigned char)(i + 1));
+        out[n].h = &m->think_time[i];
+        n++;
+    }
+    for (int i = 0; i < player_count && i < MAX_PLAYERS; i++) {
+        snprintf(out[n].name, sizeof(out[n].name), "service.p%d", (unsigned char)(i + 1));
+        out[n].h = &m->service_latency[i];
+        n++;
+    }
+    return n;
+}
+
+void metrics_dump_text(FILE *out, int player_count) {
+    named_hist_t hs[6 + 3 * MAX_PLAYERS];
+    int n = collect(hs, player_count);
+    fprintf(out, "%-20s %8s %10s %10s %10s %10s %10s %10s\n",
+            "métrica (us)", "n", "min", "p50", "p90", "p99", "max", "media");
+    for (int i = 0; i < n; i++) {
+        const hist_t *h = hs[i].h;
+        fprintf(out, "%-20s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                hs[i].name, (unsigned long long)h->count,
+                h->min / 1e3, hist_percentile(h, 0.50) / 1e3, hist_percentile(h, 0.90) / 1e3,
+                hist_percentile(h, 0.99) / 1e3, h->max / 1e3,
+                h->count ? (double)h->sum / (double)h->count / 1e3 : 0.0);
+    }
+    // Diferencia de p99 de servicio entre el jugador mejor y peor atendido.
+    uint64_t p99_min = 0, p99_max = 0;
+    bool any_served = false;
+    for (int i = 0; i < player_count && i < MAX_PLAYERS; i++) {
+        const hist_t *h = &referee_metrics.service_latency[i];
+        if (h->count == 0) continue;
+        uint64_t p99 = hist_percentile(h, 0.99);
+        if (!any_served || p99 < p99_min) p99_min = p99;
+        if (!any_served || p99 > p99_max) p99_max = p99;
+        any_served = true;
+    }
+    if (any_served) {
+        fprintf(out, "%-20s min=%.1f max=%.1f\n", "service p99", p99_min / 1e3, p99_max / 1e3);
+    }
+    uint64_t overdue = 0;
+    for (int i = 0; i < player_count && i < MAX_PLAYERS; i++) overdue += referee_metrics.overdue[i];
+    if (overdue) {
+        fprintf(out, "%-20s", "fuera de plazo");
+        for (int i = 0; i < player_count && i < MAX_PLAYERS; i++) {
+            fprintf(out, " p%d=%llu", i + 1, (unsigned long long)referee_metrics.overdue[i]);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+int metrics_dump_json(const char *path, int player_count) {
+    FILE *out = fopen(path, "w");
+    if (!out) return -1;
+    named_hist_t hs[6 + 3 * MAX_PLAYERS];
+    int n = collect(hs, player_count);
+    fprintf(out, "{\"unit\":\"ns\",\"metrics\":[");
+    for (int i = 0; i < n; i++) {
+        const hist_t *h = hs[i].h;
+        fprintf(out, "%s\n{\"name\":\"%s\",\"count\":%llu,\"sum\":%llu,\"min\":%llu,\"max\":%llu,"
+                     "\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"buckets\":[",
+                i ? "," : "", hs[i].name, (unsigned long long)h->count, (unsigned long long)h->sum,
+                (unsigned long long)h->min, (unsigned long long)h->max,
+                (unsigned long long)hist_percentile(h, 0.50), (unsigned long long)hist_percentile(h, 0.90),
+                (unsigned long long)hist_percentile(h, 0.99), (unsigned long long)hist_percentile(h, 0.999));
+        bool first = true;
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            if (!h->buckets[b]) continue;
+            fprintf(out, "%s[%llu,%llu]", first ? "" : ",",
+                    (unsigned long long)hist_bucket_lower(b), (unsigned long long)h->buckets[b]);
+            first = false;
+        }
+        fprintf(out, "]}");
+    }
+    fprintf(out, "\n],\"overdue\":[");
+    for (int i = 0; i < player_count && i < MAX_PLAYERS; i++) {
+        fprintf(out, "%s%llu", i ? "," : "", (unsigned long long)referee_metrics.overdue[i]);
+    }
+    fprintf(out, "]}\n");
+    return fclose(out);
+}
+
+static void on_sigusr1(int sig) {
+    (void)sig;
+    dump_requested = 1;
+}
+
+void metrics_install_sigusr1(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigusr1;
+    // epoll_wait igual vuelve con EINTR (ahí se atiende el pedido); el resto
+    // de las llamadas bloqueantes se reanuda solo.
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+}
+
+bool metrics_take_dump_request(void) {
+    if (!dump_requested) return false;
+    dump_requested = 0;
+    return true;
+}
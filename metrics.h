@@ -0,0 +1,72 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include "common.h"
+
+// Histogramas log-bucketed estilo HDR: 16 sub-buckets por potencia de dos
+// (error relativo < 6.25%), valores en nanosegundos.
+#define HIST_SUB_BITS 4
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[HIST_BUCKETS];
+} hist_t;
+
+static inline uint64_t metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline int hist_bucket_index(uint64_t v) {
+    if (v < HIST_SUB_COUNT) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - HIST_SUB_BITS;
+    return (msb - HIST_SUB_BITS + 1) * HIST_SUB_COUNT + (int)((v >> shift) & (HIST_SUB_COUNT - 1));
+}
+
+static inline void hist_record(hist_t *h, uint64_t v) {
+    if (h->count == 0 || v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+    h->count++;
+    h->sum += v;
+    h->buckets[hist_bucket_index(v)]++;
+}
+
+uint64_t hist_bucket_lower(int index);
+uint64_t hist_percentile(const hist_t *h, double p);
+void hist_reset(hist_t *h);
+
+// Métricas del bucle de arbitraje del master.
+typedef struct {
+    hist_t ready_to_apply;
+    hist_t master_mutex_wait;
+    hist_t state_mutex_wait;
+    hist_t master_mutex_hold;
+    hist_t state_mutex_hold;
+    hist_t view_handshake;
+    hist_t move_interval[MAX_PLAYERS];
+    hist_t think_time[MAX_PLAYERS];   // token entregado -> jugada leída
+    hist_t service_latency[MAX_PLAYERS];  // pipe listo -> jugada atendida
+    uint64_t overdue[MAX_PLAYERS];    // jugadas fuera de plazo (-b/-B)
+} referee_metrics_t;
+
+extern referee_metrics_t referee_metrics;
+
+void metrics_dump_text(FILE *out, int player_count);
+int metrics_dump_json(const char *path, int player_count);
+
+// SIGUSR1 pide un volcado; el bucle del master lo atiende con metrics_take_dump_request.
+void metrics_install_sigusr1(void);
+bool metrics_take_dump_request(void);
+
+#endif
@@ -0,0 +1,107 @@
+#define _DEFAULT_SOURCE
+#include "perfctr.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <string.h>
+#include <unistd.h>
+
+const char *const perfctr_names[PERFCTR_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+static const struct { uint32_t type; uint64_t config; } perfctr_events[PERFCTR_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static int open_event(int i, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = perfctr_events[i].type;
+    attr.config = perfctr_events[i].config;
+    attr.disabled = group_fd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+int perfctr_open(perfctr_t *pc) {
+    memset(pc, 0, sizeof(*pc));
+    pc->leader = -1;
+    int opened = 0;
+    for (int i = 0; i < PERFCTR_COUNT; i++) {
+        pc->fds[i] = open_event(i, pc->leader);
+        // Un miembro que no entra en el grupo (p. ej. por PMU distinta) se abre suelto.
+        if (pc->fds[i] == -1 && pc->leader != -1) pc->fds[i] = open_event(i, -1);
+        if (pc->fds[i] == -1) continue;
+        if (pc->leader == -1) pc->leader = pc->fds[i];
+        opened++;
+    }
+    pc->available = opened > 0;
+    return opened;
+}
+
+void perfctr_close(perfctr_t *pc) {
+    if (!pc->available) return;
+    for (int i = 0; i < PERFCTR_COUNT; i++) {
+        if (pc->fds[i] != -1) close(pc->fds[i]);
+        pc->fds[i] = -1;
+    }
+    pc->leader = -1;
+    pc->available = false;
+}
+
+static void perfctr_ioctl(perfctr_t *pc, unsigned long req) {
+    if (!pc->available) return;
+    ioctl(pc->leader, req, PERF_IOC_FLAG_GROUP);
+    for (int i = 0; i < PERFCTR_COUNT; i++) {
+        if (pc->fds[i] != -1 && pc->fds[i] != pc->leader) ioctl(pc->fds[i], req, 0);
+    }
+}
+
+void perfctr_reset(perfctr_t *pc) {
+    perfctr_ioctl(pc, PERF_EVENT_IOC_RESET);
+}
+
+void perfctr_resume(perfctr_t *pc) {
+    perfctr_ioctl(pc, PERF_EVENT_IOC_ENABLE);
+}
+
+void perfctr_pause(perfctr_t *pc) {
+    perfctr_ioctl(pc, PERF_EVENT_IOC_DISABLE);
+}
+
+void perfctr_read(perfctr_t *pc) {
+    memset(pc->valid, 0, sizeof(pc->valid));
+    if (!pc->available) return;
+    for (int i = 0; i < PERFCTR_COUNT; i++) {
+        pc->valid[i] = false;
+        pc->values[i] = 0;
+        if (pc->fds[i] == -1) continue;
+        uint64_t buf[3];
+        if (read(pc->fds[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) continue;
+        if (buf[2] == 0) continue;
+        pc->values[i] = buf[2] < buf[1] ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : buf[0];
+        pc->valid[i] = true;
+    }
+}
+
+void perfctr_print_per_op(FILE *out, const perfctr_t *pc, const char *unit, double ops) {
+    if (!pc->available) {
+        fprintf(out, " (contadores no disponibles)");
+        return;
+    }
+    if (ops <= 0) return;
+    for (int i = 0; i < PERFCTR_COUNT; i++) {
+        if (pc->valid[i]) fprintf(out, " %s/%s=%.2f", perfctr_names[i], unit, pc->values[i] / ops);
+    }
+    if (pc->valid[PERFCTR_CYCLES] && pc->valid[PERFCTR_INSTRUCTIONS] && pc->values[PERFCTR_CYCLES]) {
+        fprintf(out, " ipc=%.2f", (double)pc->values[PERFCTR_INSTRUCTIONS] / pc->values[PERFCTR_CYCLES]);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Contadores de hardware vía perf_event_open (sólo espacio de usuario, hilo
+// actual). Si el kernel o el contenedor no los exponen, available queda en
+// false y todas las operaciones son no-ops.
+typedef enum {
+    PERFCTR_CYCLES = 0,
+    PERFCTR_INSTRUCTIONS,
+    PERFCTR_L1D_MISSES,
+    PERFCTR_LLC_MISSES,
+    PERFCTR_BRANCH_MISSES,
+    PERFCTR_COUNT
+} perfctr_id_t;
+
+typedef struct {
+    int fds[PERFCTR_COUNT];
+    int leader;
+    bool available;
+    uint64_t values[PERFCTR_COUNT];
+    bool valid[PERFCTR_COUNT];
+} perfctr_t;
+
+extern const char *const perfctr_names[PERFCTR_COUNT];
+
+// Devuelve la cantidad de contadores abiertos (0 si no hay soporte).
+int perfctr_open(perfctr_t *pc);
+void perfctr_close(perfctr_t *pc);
+
+// resume/pause acumulan: se pueden envolver muchas regiones cortas y leer al final.
+void perfctr_reset(perfctr_t *pc);
+void perfctr_resume(perfctr_t *pc);
+void perfctr_pause(perfctr_t *pc);
+
+// Lee los contadores (escalados si hubo multiplexado) en values/valid.
+void perfctr_read(perfctr_t *pc);
+
+// Imprime "<nombre>/<unidad>" por contador válido, dividido por ops.
+void perfctr_print_per_op(FILE *out, const perfctr_t *pc, const char *unit, double ops);
+
+#endif // PERFCTR_H
@@ -1,5 +1,11 @@
 #include "common.h"
 #include "shm_manager.h"
+#include "strategy.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "metrics.h"
+#include "rwsync.h"
+#include "turnwait.h"
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
@@ -9,27 +15,7 @@
 #include <limits.h>
 #include <string.h>
 #include <stdbool.h>
-#include <stdint.h>
-#include <float.h>
 
-#define MAX_PLAYERS_PROBE 128
-
-
-static inline void reader_enter(game_sync_t *sync) {
-    sem_wait(&sync->master_mutex);
-    sem_post(&sync->master_mutex);
-
-    sem_wait(&sync->reader_count_mutex);
-    sync->reader_count++;
-    if (sync->reader_count == 1) sem_wait(&sync->state_mutex);
-    sem_post(&sync->reader_count_mutex);
-}
-static inline void reader_exit(game_sync_t *sync) {
-    sem_wait(&sync->reader_count_mutex);
-    sync->reader_count--;
-    if (sync->reader_count == 0) sem_post(&sync->state_mutex);
-    sem_post(&sync->reader_count_mutex);
-}
 
 static int find_my_index(game_state_t *gs, game_sync_t *sync) {
     pid_t me = getpid();
@@ -46,251 +32,107 @@ static int find_my_index(game_state_t *gs, game_sync_t *sync) {
     return idx;
 }
 
-static inline void target_from_dir(int gx, int gy, int d, int *tx, int *ty) {
-    int nx = gx, ny = gy;
-    switch (d) {
-        case UP:        ny--; break;
-        case UP_RIGHT:  ny--; nx++; break;
-        case RIGHT:     nx++; break;
-        case DOWN_RIGHT:ny++; nx++; break;
-        case DOWN:      ny++; break;
-        case DOWN_LEFT: ny++; nx--; break;
-        case LEFT:      nx--; break;
-        case UP_LEFT:   ny--; nx--; break;
-        default: break;
-    }
-    *tx = nx;
-    *ty = ny;
+static void publish_decision(telemetry_player_t *tel, const strategy_stats_t *st, const turn_spin_t *spin, uint64_t think_ns, uint64_t lock_wait_ns) {
+    uint64_t decisions = atomic_load_explicit(&tel->decisions, memory_order_relaxed) + 1;
+    atomic_store_explicit(&tel->decisions, decisions, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tel->think_ns_total, think_ns, memory_order_relaxed);
+    atomic_store_explicit(&tel->think_ns_last, think_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tel->sims_total, st->sims, memory_order_relaxed);
+    atomic_store_explicit(&tel->sims_per_sec, think_ns ? st->sims * 1000000000ull / think_ns : 0, memory_order_relaxed);
+    atomic_store_explicit(&tel->depth_avg, st->sims ? (uint32_t)(st->playout_moves / st->sims) : 0, memory_order_relaxed);
+    atomic_store_explicit(&tel->depth_max, (uint32_t)st->max_depth, memory_order_relaxed);
+    atomic_store_explicit(&tel->lock_wait_ns, lock_wait_ns, memory_order_relaxed);
+    atomic_store_explicit(&tel->tokens, spin->tokens, memory_order_relaxed);
+    atomic_store_explicit(&tel->wake_ns_total, spin->wake_ns_total, memory_order_relaxed);
+    atomic_store_explicit(&tel->spin_hits, spin->spin_hits, memory_order_relaxed);
+    atomic_store_explicit(&tel->spin_misses, spin->spin_misses, memory_order_relaxed);
+    if ((decisions & 15) == 1) atomic_store_explicit(&tel->rss_kb, telemetry_rss_kb(), memory_order_relaxed);
+    atomic_store_explicit(&tel->updated_ns, metrics_now_ns(), memory_order_relaxed);
 }
 
-typedef struct { int x,y; unsigned int score; bool blocked; } sim_player_t;
-
-static inline bool sim_is_valid_move(int *board, int width, int height, sim_player_t *players, int pid, int d) {
-    int gx = players[pid].x;
-    int gy = players[pid].y;
-    int tx, ty;
-    target_from_dir(gx, gy, d, &tx, &ty);
-    if (tx < 0 || tx >= width || ty < 0 || ty >= height) {
+// Modo pool (chompd): avisa que quedó libre y espera a que arranque la próxima partida.
+static bool wait_next_game(game_state_t *gs, game_sync_t *sync, int my_index) {
+    unsigned char mark = PLAYER_IDLE_MARK;
+    if (write(STDOUT_FILENO, &mark, 1) != 1) {
         return false;
     }
-    return board[ty * width + tx] > 0;
-}
-
-static inline int sim_apply_move(int *board, int width, int height, sim_player_t *players, int pid, int d) {
-    int gx = players[pid].x;
-    int gy = players[pid].y;
-    int tx, ty;
-    target_from_dir(gx, gy, d, &tx, &ty);
-    if (tx < 0 || tx >= width || ty < 0 || ty >= height) {
-        return -1;
-    }
-    int idx = ty * width + tx;
-    int reward = board[idx];
-    if (reward <= 0) {
-        return -1;
-    }
-    players[pid].score += (unsigned int)reward;
-    board[idx] = -(pid + 1);
-    players[pid].x = tx;
-    players[pid].y = ty;
-    players[pid].blocked = false;
-    return reward;
-}
-
-static bool sim_any_player_has_move(int *board, int width, int height, sim_player_t *players, int player_count) {
-    for (int i = 0; i < player_count; i++) {
-        if (players[i].blocked) {
-            continue;
-        }
-        for (int d = 0; d < 8; d++) {
-            if (sim_is_valid_move(board, width, height, players, i, d)) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-static int sim_count_liberties(int *board, int width, int height, sim_player_t *players, int pid) {
-    int gx = players[pid].x;
-    int gy = players[pid].y;
-    int c = 0;
-    for (int d = 0; d < 8; d++) {
-        int tx, ty;
-        target_from_dir(gx, gy, d, &tx, &ty);
-        if (tx < 0 || tx >= width || ty < 0 || ty >= height) {
-            continue;
-        }
-        if (board[ty * width + tx] > 0) {
-            c++;
+    do {
+        if (sem_wait(&sync->player_mutex[my_index]) == -1 && errno != EINTR) {
+            return false;
         }
-    }
-    return c;
+    } while (gs->game_over);
+    // El token consumido es el de la primera jugada: se devuelve para el bucle principal.
+    sem_post(&sync->player_mutex[my_index]);
+    return true;
 }
 
-static int sim_pick_policy_move(int *board, int width, int height, sim_player_t *players, int player_count, int pid) {
-    (void)player_count;
-    int valid_dirs[8];
-    int valid_count = 0;
-    int best_dirs[8];
-    int best_count = 0;
-    double best_score = -DBL_MAX;
-
-    for (int d = 0; d < 8; d++) {
-        int tx, ty;
-        target_from_dir(players[pid].x, players[pid].y, d, &tx, &ty);
-        if (tx < 0 || tx >= width || ty < 0 || ty >= height) {
-            continue;
-        }
-        int cell = board[ty * width + tx];
-        if (cell <= 0) {
-            continue;
-        }
-        valid_dirs[valid_count++] = d;
-    }
-
-    if (valid_count == 0) {
-        return -1;
-    }
-
-    if ((rand() & 0xFF) < 30) {
-        return valid_dirs[rand() % valid_count];
-    }
-
-    for (int i = 0; i < valid_count; i++) {
-        int d = valid_dirs[i];
-        int tx, ty;
-        target_from_dir(players[pid].x, players[pid].y, d, &tx, &ty);
-        int saved = board[ty * width + tx];
-        board[ty * width + tx] = -(pid + 1);
-        int oldx = players[pid].x;
-        int oldy = players[pid].y;
-        players[pid].x = tx;
-        players[pid].y = ty;
-        int lib = sim_count_liberties(board, width, height, players, pid);
-        players[pid].x = oldx;
-        players[pid].y = oldy;
-        board[ty * width + tx] = saved;
-
-        double score = (double)saved + 1.5 * (double)lib;
-        if (score > best_score) {
-            best_score = score;
-            best_count = 0;
-            best_dirs[best_count++] = d;
-        } else if (score == best_score) {
-            best_dirs[best_count++] = d;
-        }
-    }
-
-    return best_dirs[rand() % best_count];
+// Modo --profile: contadores de hardware acumulados durante toda la partida.
+typedef struct {
+    perfctr_t playout;
+    perfctr_t voronoi;
+    unsigned long sims;
+    unsigned long playout_moves;
+    unsigned long voronoi_cells;
+    uint64_t think_ns;
+} player_profile_t;
+
+static void profile_report(player_profile_t *prof, int my_index) {
+    perfctr_read(&prof->playout);
+    perfctr_read(&prof->voronoi);
+    fprintf(stderr, "player %d perfil: %lu playouts, %lu pasos, %.1f ns/paso (incluye toda la búsqueda)\n",
+            my_index, prof->sims, prof->playout_moves,
+            prof->playout_moves ? (double)prof->think_ns / prof->playout_moves : 0.0);
+    fprintf(stderr, "  playout:");
+    perfctr_print_per_op(stderr, &prof->playout, "paso", (double)prof->playout_moves);
+    fprintf(stderr, "\n  voronoi: %lu celdas", prof->voronoi_cells);
+    perfctr_print_per_op(stderr, &prof->voronoi, "celda", (double)prof->voronoi_cells);
+    fprintf(stderr, "\n");
 }
 
-static void compute_voronoi_potential_buf(int *board, int width, int height, sim_player_t *players, int player_count, unsigned int *vor_out, int *dist, int *owner, int *qx, int *qy, int *qo) {
-    int n = width * height;
-    for (int i = 0; i < n; i++) {
-        dist[i] = INT_MAX;
-        owner[i] = -1;
-    }
-
-    int qh = 0;
-    int qt = 0;
-
-    for (int p = 0; p < player_count; p++) {
-        if (players[p].blocked) {
-            continue;
-        }
-        int x = players[p].x;
-        int y = players[p].y;
-        int idx = y * width + x;
-        dist[idx] = 0;
-        owner[idx] = p;
-        qx[qt] = x;
-        qy[qt] = y;
-        qo[qt] = p;
-        qt++;
-    }
-
-    while (qh < qt) {
-        int x = qx[qh];
-        int y = qy[qh];
-        int p = qo[qh];
-        qh++;
-        int base = y * width + x;
-        int dcur = dist[base];
-        for (int dir = 0; dir < 8; dir++) {
-            int nx, ny;
-            target_from_dir(x, y, dir, &nx, &ny);
-            if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
-                continue;
+int main(int argc, char *argv[]) {
+    bool profile = getenv("CHOMP_PROFILE") != NULL;
+    bool set_engine = false;
+    strategy_engine_t engine = STRATEGY_ENGINE_MC;
+    int ab_threads = 1;
+    const char *params_spec = NULL;
+    while (argc > 3 && strncmp(argv[1], "--", 2) == 0) {
+        if (strcmp(argv[1], "--profile") == 0) {
+            profile = true;
+        } else if (strncmp(argv[1], "--kernel=", 9) == 0) {
+            if (sim_kernel_select(argv[1] + 9) == -1) {
+                fprintf(stderr, "Núcleos %s no disponibles en esta CPU\n", argv[1] + 9);
+                return EXIT_FAILURE;
             }
-            int nidx = ny * width + nx;
-            if (board[nidx] <= 0) {
-                continue;
+        } else if (strncmp(argv[1], "--engine=", 9) == 0) {
+            if (strategy_engine_parse(argv[1] + 9, &engine) == -1) {
+                fprintf(stderr, "Motor desconocido: %s\n", argv[1] + 9);
+                return EXIT_FAILURE;
             }
-            int nd = dcur + 1;
-            if (nd < dist[nidx]) {
-                dist[nidx] = nd;
-                owner[nidx] = p;
-                qx[qt] = nx;
-                qy[qt] = ny;
-                qo[qt] = p;
-                qt++;
-            } else if (nd == dist[nidx] && owner[nidx] != p) {
-                owner[nidx] = -2;
+            set_engine = true;
+        } else if (strncmp(argv[1], "--threads=", 10) == 0) {
+            ab_threads = atoi(argv[1] + 10);
+            set_engine = true;
+        } else if (strncmp(argv[1], "--params=", 9) == 0) {
+            strategy_params_t check = STRATEGY_PARAMS_DEFAULT;
+            params_spec = argv[1] + 9;
+            if (strategy_params_parse(params_spec, &check) == -1) {
+                fprintf(stderr, "Parámetros inválidos: %s\n", params_spec);
+                return EXIT_FAILURE;
             }
+        } else {
+            break;
         }
+        argv[1] = argv[0];
+        argv++;
+        argc--;
     }
-
-    for (int p = 0; p < player_count; p++) {
-        vor_out[p] = 0u;
-    }
-    for (int i = 0; i < n; i++) {
-        if (board[i] <= 0) {
-            continue;
-        }
-        int o = owner[i];
-        if (o >= 0) {
-            vor_out[o] += (unsigned int)board[i];
-        }
-    }
-}
-
-static void copy_board(int *dst, int *src, int n) {
-    memcpy(dst, src, n * sizeof(int));
-}
-static void copy_players_sim(sim_player_t *dst, player_t *src, unsigned int count) {
-    for (unsigned int i = 0; i < count; i++) {
-        dst[i].x = (int)src[i].x;
-        dst[i].y = (int)src[i].y;
-        dst[i].score = src[i].score;
-        dst[i].blocked = src[i].blocked;
-    }
-}
-
-static void simulate_playout(int *board, int width, int height, sim_player_t *players, int player_count, int start_next_player) {
-    int next = start_next_player;
-    while (sim_any_player_has_move(board, width, height, players, player_count)) {
-        int p = next;
-        next = (next + 1) % player_count;
-        if (players[p].blocked) {
-            continue;
-        }
-        int mv = sim_pick_policy_move(board, width, height, players, player_count, p);
-        if (mv == -1) {
-            players[p].blocked = true;
-            continue;
-        }
-        sim_apply_move(board, width, height, players, p, mv);
-    }
-}
-
-int main(int argc, char *argv[]) {
     if (argc != 3) {
-        fprintf(stderr, "Uso: %s <ancho> <alto>\n", argv[0]);
+        fprintf(stderr, "Uso: %s [--profile] [--kernel=auto|scalar|sse4.2|avx2|avx512] [--engine=mc|ab|auto] [--threads=N] [--params=lib=1.5,eps=30,...] <ancho> <alto>\n", argv[0]);
         return EXIT_FAILURE;
     }
     int width = atoi(argv[1]);
     int height = atoi(argv[2]);
+    bool pool = getenv("CHOMP_POOL") != NULL;
 
     shm_manager_t *state_mgr = shm_manager_open(SHM_GAME_STATE, 0, 0);
     if (!state_mgr) {
@@ -321,7 +163,7 @@ int main(int argc, char *argv[]) {
     int my_index = -1;
     const int max_iters = 500;
     int it = 0;
-    while (my_index == -1 && !game_state->game_over && it < max_iters) {
+    while (my_index == -1 && (pool || !game_state->game_over) && it < max_iters) {
         my_index = find_my_index(game_state, game_sync);
         if (my_index != -1) {
             break;
@@ -341,120 +183,117 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    srand((unsigned int)(getpid() ^ time(NULL)));
-
-    int cells = width * height;
-    int *board_snapshot = malloc(cells * sizeof(int));
-    int *board_sim = malloc(cells * sizeof(int));
-    sim_player_t *players_snapshot = malloc(sizeof(sim_player_t) * game_state->player_count);
-    sim_player_t *players_sim = malloc(sizeof(sim_player_t) * game_state->player_count);
-    unsigned int *vor_tmp = malloc(sizeof(unsigned int) * game_state->player_count);
-    
-    int *dist = malloc(sizeof(int) * cells);
-    int *owner = malloc(sizeof(int) * cells);
-    int *qx = malloc(sizeof(int) * cells);
-    int *qy = malloc(sizeof(int) * cells);
-    int *qo = malloc(sizeof(int) * cells);
-    if (!board_snapshot || !board_sim || !players_snapshot || !players_sim || !vor_tmp || !dist || !owner || !qx || !qy || !qo) {
+    trace_attach("player");
+    telemetry_player_t *tel = NULL;
+    if (telemetry_attach() == 0) {
+        tel = &telemetry->players[my_index];
+        atomic_store(&tel->pid, getpid());
+    }
+    uint64_t lock_wait_ns = 0;
+    const char *spin_env = getenv("CHOMP_SPIN_US");
+    turn_spin_t spin;
+    turn_spin_init(&spin, game_sync, my_index, spin_env ? (unsigned int)atoi(spin_env) : 0);
+
+    strategy_t *strategy = strategy_create(width, height, (int)game_state->player_count,
+                                           (unsigned int)(getpid() ^ time(NULL)));
+    if (!strategy || (set_engine && strategy_set_engine(strategy, engine, ab_threads) == -1)) {
         fprintf(stderr, "allocation failed\n");
         return EXIT_FAILURE;
     }
+    if (params_spec) {
+        // Sobre lo que ya haya puesto CHOMP_PARAMS.
+        strategy_params_t params = *strategy_get_params(strategy);
+        strategy_params_parse(params_spec, &params);
+        strategy_set_params(strategy, &params);
+    }
+    int *board_snapshot = strategy_board_snapshot(strategy);
+    sim_player_t *players_snapshot = strategy_players_snapshot(strategy);
+    player_profile_t prof;
+    memset(&prof, 0, sizeof(prof));
+    if (profile) {
+        perfctr_open(&prof.playout);
+        perfctr_open(&prof.voronoi);
+        strategy_set_profile(strategy, &prof.playout, &prof.voronoi);
+    }
 
-    while (1) {
+    do {
+        while (1) {
         
-        if (sem_wait(&game_sync->player_mutex[my_index]) == -1) {
-            if (errno == EINTR) {
-                continue;
+            trace_begin(TR_TOKEN_WAIT);
+            int wait_rc = turn_wait(&spin, game_sync, my_index);
+            int wait_err = errno;
+            trace_end(TR_TOKEN_WAIT, wait_rc);
+            if (wait_rc == -1) {
+                if (wait_err == EINTR) {
+                    continue;
+                }
+                break;
             }
-            break;
-        }
-
-        if (game_state->game_over) {
-            break;
-        }
 
-        if (game_state->players[my_index].blocked) {
-            break;
-        }
+            if (game_state->game_over) {
+                break;
+            }
 
-        reader_enter(game_sync);
-        if (game_state->game_over) {
-            reader_exit(game_sync);
-            break;
-        }
+            if (game_state->players[my_index].blocked) {
+                break;
+            }
 
-        int gx = (int)game_state->players[my_index].x;
-        int gy = (int)game_state->players[my_index].y;
-        int gwidth = game_state->width;
-        int gheight = game_state->height;
-        unsigned int gplayer_count = game_state->player_count;
+            trace_begin(TR_SNAPSHOT);
+            uint64_t wait_t0 = metrics_now_ns();
+            reader_enter(game_sync);
+            lock_wait_ns += metrics_now_ns() - wait_t0;
+            if (game_state->game_over) {
+                reader_exit(game_sync);
+                trace_end(TR_SNAPSHOT, -1);
+                break;
+            }
 
-        copy_board(board_snapshot, game_state->board, gwidth * gheight);
-        copy_players_sim(players_snapshot, game_state->players, gplayer_count);
-        reader_exit(game_sync);
+            int gx = (int)game_state->players[my_index].x;
+            int gy = (int)game_state->players[my_index].y;
+            int gwidth = game_state->width;
+            int gheight = game_state->height;
+            unsigned int gplayer_count = game_state->player_count;
 
-        int valid_dirs[8];
-        int valid_count = 0;
-        int immediate_vals[8];
-        for (int d = 0; d < 8; d++) {
-            int tx, ty;
-            target_from_dir(gx, gy, d, &tx, &ty);
-            if (tx < 0 || tx >= gwidth || ty < 0 || ty >= gheight) {
-                continue;
+            memcpy(board_snapshot, game_state->board, gwidth * gheight * sizeof(int));
+            strategy_players_from_state(players_snapshot, game_state->players, gplayer_count);
+            reader_exit(game_sync);
+            trace_end(TR_SNAPSHOT, 0);
+
+            strategy_state_t st = {
+                .width = gwidth,
+                .height = gheight,
+                .player_count = (int)gplayer_count,
+                .my_index = my_index,
+                .board = board_snapshot,
+                .players = players_snapshot
+            };
+            trace_begin(TR_SEARCH);
+            uint64_t think_t0 = metrics_now_ns();
+            int pick = strategy_decide(strategy, &st, NULL);
+            uint64_t think_ns = metrics_now_ns() - think_t0;
+            trace_end(TR_SEARCH, pick);
+            if (tel) publish_decision(tel, strategy_last_stats(strategy), &spin, think_ns, lock_wait_ns);
+            if (profile) {
+                const strategy_stats_t *ss = strategy_last_stats(strategy);
+                prof.sims += ss->sims;
+                prof.playout_moves += ss->playout_moves;
+                prof.voronoi_cells += ss->voronoi_cells;
+                prof.think_ns += think_ns;
             }
-            int cell = board_snapshot[ty * gwidth + tx];
-            if (cell <= 0) {
+            if (pick == -1) {
                 continue;
             }
-            valid_dirs[valid_count] = d;
-            immediate_vals[valid_count] = cell;
-            valid_count++;
-        }
-        if (valid_count == 0) {
-            continue;
-        }
 
-        int free_cells = 0;
-        for (int i = 0; i < cells; i++) {
-            if (board_snapshot[i] > 0) {
-                free_cells++;
-            }
-        }
-        int opening_threshold = (int)(cells * 0.55);
-        if (free_cells >= opening_threshold) {
-        
-            double bestv = -DBL_MAX;
-            int bests[8];
-            int bc = 0;
-            for (int i = 0; i < valid_count; i++) {
-                int d = valid_dirs[i];
-                int tx, ty;
-                target_from_dir(gx, gy, d, &tx, &ty);
-                int neigh_sum = 0;
-                for (int dd = 0; dd < 8; dd++) {
-                    int nx, ny;
-                    target_from_dir(tx, ty, dd, &nx, &ny);
-                    if (nx < 0 || nx >= gwidth || ny < 0 || ny >= gheight) {
-                        continue;
-                    }
-                    int v = board_snapshot[ny * gwidth + nx];
-                    if (v > 0) {
-                        neigh_sum += v;
-                    }
-                }
-                double val = (double)immediate_vals[i] + 0.25 * (double)neigh_sum;
-                if (val > bestv) {
-                    bestv = val;
-                    bc = 0;
-                    bests[bc++] = d;
-                } else if (val == bestv) {
-                    bests[bc++] = d;
-                }
-            }
-            int pick = bests[rand() % bc];
+            unsigned char move = (unsigned char)pick;
 
-            if (sem_wait(&game_sync->state_mutex) == -1) {
-                if (errno == EINTR) {
+            trace_begin(TR_WRITE);
+            wait_t0 = metrics_now_ns();
+            int wrc = sem_wait(&game_sync->state_mutex);
+            lock_wait_ns += metrics_now_ns() - wait_t0;
+            if (wrc == -1) {
+                int err = errno;
+                trace_end(TR_WRITE, -1);
+                if (err == EINTR) {
                     sem_post(&game_sync->player_mutex[my_index]);
                     continue;
                 }
@@ -462,144 +301,34 @@ int main(int argc, char *argv[]) {
             }
             if (game_state->game_over) {
                 sem_post(&game_sync->state_mutex);
+                trace_end(TR_WRITE, -1);
                 break;
             }
             if ((int)game_state->players[my_index].x != gx || (int)game_state->players[my_index].y != gy || game_state->players[my_index].blocked) {
                 sem_post(&game_sync->state_mutex);
+                trace_end(TR_WRITE, -1);
                 continue;
             }
-            unsigned char mv = (unsigned char)pick;
-            ssize_t w = write(STDOUT_FILENO, &mv, 1);
+            ssize_t written = write(STDOUT_FILENO, &move, 1);
             sem_post(&game_sync->state_mutex);
-            if (w != 1) {
-                if (w == -1 && errno == EPIPE) {
+            trace_end(TR_WRITE, move);
+            if (written != 1) {
+                if (written == -1 && errno == EPIPE) {
                     break;
                 }
                 break;
             }
-            continue;
-        }
-
-        int K = 3;
-        if (valid_count < K) {
-            K = valid_count;
-        }
-        int idxs[8];
-        for (int i = 0; i < valid_count; i++) idxs[i] = i;
-        for (int i = 0; i < K; i++) {
-            int best = i;
-            for (int j = i + 1; j < valid_count; j++) {
-                if (immediate_vals[idxs[j]] > immediate_vals[idxs[best]]) {
-                    best = j;
-                }
-            }
-            int tmp = idxs[i];
-            idxs[i] = idxs[best];
-            idxs[best] = tmp;
-        }
-
-        int board_cells = gwidth * gheight;
-        int sims_per_candidate = 400;
-        if (board_cells <= 25) sims_per_candidate = 500;
-        else if (board_cells <= 100) sims_per_candidate = 300;
-        else if (board_cells <= 400) sims_per_candidate = 150;
-        else sims_per_candidate = 80;
-        int max_total_sims = 2000;
-        long total_sims = (long)sims_per_candidate * K;
-        if (total_sims > max_total_sims) sims_per_candidate = max_total_sims / K;
-        if (sims_per_candidate < 5) sims_per_candidate = 5;
-
-        double best_avg = -DBL_MAX;
-        int bests2[8];
-        int bestc2 = 0;
-        double candidate_avgs[8];
-        for (int i = 0; i < valid_count; i++) candidate_avgs[i] = (double)immediate_vals[i];
-
-        for (int t = 0; t < K; t++) {
-            int ci = idxs[t];
-            int cand = valid_dirs[ci];
-            double sum_score = 0.0;
-            for (int s = 0; s < sims_per_candidate; s++) {
-                copy_board(board_sim, board_snapshot, gwidth * gheight);
-                memcpy(players_sim, players_snapshot, sizeof(sim_player_t) * gplayer_count);
-                int immediate = sim_apply_move(board_sim, gwidth, gheight, players_sim, my_index, cand);
-                if (immediate < 0) {
-                    players_sim[my_index].blocked = true;
-                }
-                int next = (my_index + 1) % gplayer_count;
-                simulate_playout(board_sim, gwidth, gheight, players_sim, gplayer_count, next);
-                sum_score += (double)players_sim[my_index].score;
-            }
-            double avg = sum_score / (double)sims_per_candidate;
-            candidate_avgs[ci] = avg;
-            if (avg > best_avg) {
-                best_avg = avg;
-                bestc2 = 0;
-                bests2[bestc2++] = cand;
-            } else if (avg == best_avg) {
-                bests2[bestc2++] = cand;
-            }
-        }
-
-        int pick = bests2[rand() % bestc2];
-        if (bestc2 > 1) {
-            double best_comb = -DBL_MAX;
-            int topk = bestc2;
-            if (topk > 4) topk = 4;
-            for (int t = 0; t < topk; t++) {
-                int cand = bests2[t];
-                copy_board(board_sim, board_snapshot, gwidth * gheight);
-                memcpy(players_sim, players_snapshot, sizeof(sim_player_t) * gplayer_count);
-                sim_apply_move(board_sim, gwidth, gheight, players_sim, my_index, cand);
-                compute_voronoi_potential_buf(board_sim, gwidth, gheight, players_sim, gplayer_count, vor_tmp, dist, owner, qx, qy, qo);
-                double my_vor = (double)vor_tmp[my_index];
-                double gamma = 0.03;
-                double avg = candidate_avgs[t];
-                double combined = avg + gamma * my_vor;
-                if (combined > best_comb) {
-                    best_comb = combined;
-                    pick = cand;
-                }
-            }
         }
+    } while (pool && wait_next_game(game_state, game_sync, my_index));
 
-        unsigned char move = (unsigned char)pick;
-
-        if (sem_wait(&game_sync->state_mutex) == -1) {
-            if (errno == EINTR) {
-                sem_post(&game_sync->player_mutex[my_index]);
-                continue;
-            }
-            break;
-        }
-        if (game_state->game_over) {
-            sem_post(&game_sync->state_mutex);
-            break;
-        }
-        if ((int)game_state->players[my_index].x != gx || (int)game_state->players[my_index].y != gy || game_state->players[my_index].blocked) {
-            sem_post(&game_sync->state_mutex);
-            continue;
-        }
-        ssize_t written = write(STDOUT_FILENO, &move, 1);
-        sem_post(&game_sync->state_mutex);
-        if (written != 1) {
-            if (written == -1 && errno == EPIPE) {
-                break;
-            }
-            break;
-        }
+    if (profile) {
+        profile_report(&prof, my_index);
+        perfctr_close(&prof.playout);
+        perfctr_close(&prof.voronoi);
     }
-
-    free(board_snapshot);
-    free(board_sim);
-    free(players_snapshot);
-    free(players_sim);
-    free(vor_tmp);
-    free(dist);
-    free(owner);
-    free(qx);
-    free(qy);
-    free(qo);
+    strategy_destroy(strategy);
+    trace_detach();
+    telemetry_close();
     shm_manager_close(state_mgr);
     shm_manager_close(sync_mgr);
     return EXIT_SUCCESS;
@@ -0,0 +1,268 @@
+#include "common.h"
+#include "strategy.h"
+#include "position.h"
+#include "metrics.h"
+#include <pthread.h>
+#include <getopt.h>
+
+// Análisis offline de una posición con la misma búsqueda del player, sin
+// memoria compartida ni master. Con -j N corre N búsquedas independientes
+// (semillas distintas) en paralelo y junta las estadísticas por candidata.
+
+static const char *const dir_names[8] = { "N", "NE", "E", "SE", "S", "SO", "O", "NO" };
+
+typedef struct {
+    int threads;
+    int line_depth;
+    unsigned int seed;
+    strategy_budget_t budget;
+    bool use_budget;
+    bool set_engine;
+    strategy_engine_t engine;
+} analyze_opts_t;
+
+typedef struct {
+    const position_t *pos;
+    const analyze_opts_t *opts;
+    unsigned int seed;
+    int pick;
+    strategy_stats_t stats;
+    int rc;
+} search_job_t;
+
+typedef struct {
+    int positions;
+    int comparable;
+    int agree;
+    unsigned long nodes;
+    uint64_t wall_ns;
+} analyze_totals_t;
+
+static strategy_state_t state_of(const position_t *pos, int to_move) {
+    strategy_state_t st = {
+        .width = pos->width,
+        .height = pos->height,
+        .player_count = pos->player_count,
+        .my_index = to_move,
+        .board = pos->board,
+        .players = pos->players
+    };
+    return st;
+}
+
+static strategy_t *create_strategy(const position_t *pos, const analyze_opts_t *o, unsigned int seed) {
+    strategy_t *s = strategy_create(pos->width, pos->height, pos->player_count, seed);
+    if (s && o->set_engine && strategy_set_engine(s, o->engine, 1) == -1) {
+        strategy_destroy(s);
+        return NULL;
+    }
+    return s;
+}
+
+static void *search_worker(void *arg) {
+    search_job_t *job = arg;
+    const position_t *pos = job->pos;
+    strategy_t *s = create_strategy(pos, job->opts, job->seed);
+    if (!s) {
+        job->rc = -1;
+        return NULL;
+    }
+    strategy_state_t st = state_of(pos, pos->to_move);
+    job->pick = strategy_decide(s, &st, job->opts->use_budget ? &job->opts->budget : NULL);
+    job->stats = *strategy_last_stats(s);
+    strategy_destroy(s);
+    return NULL;
+}
+
+// Sigue la partida desde pos jugando best y después la elección de cada jugador.
+static void print_line(const position_t *pos, int best, const analyze_opts_t *o) {
+    int cells = pos->width * pos->height;
+    int *board = malloc(sizeof(int) * cells);
+    strategy_t *s = create_strategy(pos, o, o->seed);
+    if (!board || !s) {
+        free(board);
+        strategy_destroy(s);
+        return;
+    }
+    sim_player_t players[MAX_PLAYERS];
+    memcpy(board, pos->board, sizeof(int) * cells);
+    memcpy(players, pos->players, sizeof(players));
+    position_t cur = *pos;
+    cur.board = board;
+
+    printf("línea principal:");
+    int who = pos->to_move;
+    int dir = best;
+    for (int ply = 0; ply < o->line_depth && dir >= 0; ply++) {
+        printf(" %s@p%d", dir_names[dir], who);
+        sim_apply_move(board, pos->width, pos->height, players, who, dir);
+        dir = -1;
+        for (int k = 1; k <= pos->player_count && dir < 0; k++) {
+            int next = (who + k) % pos->player_count;
+            if (players[next].blocked) continue;
+            memcpy(cur.players, players, sizeof(players));
+            strategy_state_t st = state_of(&cur, next);
+            dir = strategy_decide(s, &st, o->use_budget ? &o->budget : NULL);
+            if (dir < 0) players[next].blocked = true;
+            else who = next;
+        }
+    }
+    printf("\n");
+    free(board);
+    strategy_destroy(s);
+}
+
+static int analyze_position(const char *path, const analyze_opts_t *o, analyze_totals_t *tot) {
+    position_t pos;
+    if (position_load(path, &pos) == -1) {
+        perror(path);
+        return -1;
+    }
+
+    search_job_t jobs[64];
+    pthread_t tids[64];
+    int threads = o->threads;
+    uint64_t t0 = metrics_now_ns();
+    for (int i = 0; i < threads; i++) {
+        jobs[i] = (search_job_t){ .pos = &pos, .opts = o, .seed = o->seed + (unsigned int)i };
+        if (pthread_create(&tids[i], NULL, search_worker, &jobs[i]) != 0) {
+            perror("pthread_create");
+            threads = i;
+            break;
+        }
+    }
+    for (int i = 0; i < threads; i++) pthread_join(tids[i], NULL);
+    uint64_t wall_ns = metrics_now_ns() - t0;
+    // Un hilo que falló queda con pick 0 y estadísticas en cero: no cuenta.
+    int ok = 0;
+    const strategy_stats_t *first = NULL;
+    for (int i = 0; i < threads; i++) {
+        if (jobs[i].rc == -1) continue;
+        if (!first) first = &jobs[i].stats;
+        ok++;
+    }
+    if (!first) {
+        position_free(&pos);
+        return -1;
+    }
+
+    // Se juntan las candidatas de todos los hilos; sin playouts gana el voto de mayoría.
+    unsigned long sims[8] = {0}, nodes = 0;
+    double score[8] = {0};
+    int votes[8] = {0};
+    for (int i = 0; i < threads; i++) {
+        if (jobs[i].rc == -1) continue;
+        const strategy_stats_t *st = &jobs[i].stats;
+        nodes += st->alphabeta ? st->nodes : st->playout_moves;
+        for (int c = 0; c < st->candidate_count; c++) {
+            sims[c] += st->candidates[c].sims;
+            score[c] += st->candidates[c].score_sum;
+        }
+        for (int c = 0; c < first->candidate_count; c++) {
+            if (first->candidates[c].dir == jobs[i].pick) votes[c]++;
+        }
+    }
+    int best = -1, best_c = -1;
+    for (int c = 0; c < first->candidate_count; c++) {
+        bool better;
+        if (best_c == -1) better = true;
+        else if (votes[c] != votes[best_c]) better = votes[c] > votes[best_c];
+        else better = sims[c] && sims[best_c] && score[c] / sims[c] > score[best_c] / sims[best_c];
+        if (better) best_c = c;
+    }
+    if (best_c >= 0) best = first->candidates[best_c].dir;
+
+    uint64_t best_ns = 0;
+    bool found = false;
+    for (int i = 0; i < threads; i++) {
+        if (jobs[i].rc == -1 || jobs[i].pick != best) continue;
+        if (!found || jobs[i].stats.best_ns < best_ns) best_ns = jobs[i].stats.best_ns;
+        found = true;
+    }
+
+    printf("== %s (%dx%d, juega p%d", path, pos.width, pos.height, pos.to_move);
+    if (pos.played >= 0 && pos.played < 8) printf(", en la partida: %s", dir_names[pos.played]);
+    if (first->alphabeta) printf(", alfa-beta prof %d)\n", first->max_depth);
+    else printf(", %s)\n", first->book ? "libro" : first->opening ? "apertura" : first->learned ? "evaluador aprendido" : "montecarlo");
+    printf("%-4s %9s %8s %12s %10s %8s %6s\n", "dir", "inmediata", "valor", "sims", "media", "voronoi", "votos");
+    for (int c = 0; c < first->candidate_count; c++) {
+        const strategy_candidate_t *cd = &first->candidates[c];
+        printf("%-4s %9d %8.2f %12lu %10.2f %8u %6d%s\n", dir_names[cd->dir], cd->immediate, cd->value, sims[c],
+               sims[c] ? score[c] / sims[c] : 0.0, cd->voronoi, votes[c], cd->dir == best ? "  *" : "");
+    }
+    if (best < 0) {
+        printf("sin jugadas válidas\n");
+    } else {
+        printf("mejor: %s  tiempo_a_mejor=%.3f ms  total=%.3f ms  hilos=%d  nodos=%lu  nodos/s=%.0f\n",
+               dir_names[best], best_ns / 1e6, wall_ns / 1e6, ok, nodes,
+               wall_ns ? nodes * 1e9 / (double)wall_ns : 0.0);
+        if (o->line_depth > 0) print_line(&pos, best, o);
+    }
+
+    tot->positions++;
+    tot->nodes += nodes;
+    tot->wall_ns += wall_ns;
+    if (pos.played >= 0) {
+        tot->comparable++;
+        if (best == pos.played) tot->agree++;
+    }
+    position_free(&pos);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    analyze_opts_t o = { .threads = 1, .line_depth = 8, .seed = 12345 };
+    int opt;
+    while ((opt = getopt(argc, argv, "j:S:T:s:l:e:")) != -1) {
+        switch (opt) {
+            case 'j': o.threads = atoi(optarg); break;
+            case 'S': o.budget.max_sims = atoi(optarg); o.use_budget = true; break;
+            case 'T': o.budget.time_ms = atoi(optarg); o.use_budget = true; break;
+            case 's': o.seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'l': o.line_depth = atoi(optarg); break;
+            case 'e':
+                if (strategy_engine_parse(optarg, &o.engine) == -1) {
+                    fprintf(stderr, "Motor desconocido: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                o.set_engine = true;
+                break;
+            default:
+                fprintf(stderr, "Uso: %s [-j hilos] [-S max_sims] [-T time_ms] [-s seed] [-l profundidad_linea] [-e mc|ab|auto] posicion.pos|directorio ...\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (o.threads < 1) o.threads = 1;
+    if (o.threads > 64) o.threads = 64;
+    if (optind >= argc) {
+        fprintf(stderr, "Falta la posición (archivo .pos o directorio)\n");
+        return EXIT_FAILURE;
+    }
+
+    char **paths = NULL;
+    int count = 0;
+    for (int i = optind; i < argc; i++) {
+        int n = position_collect(argv[i], &paths, count);
+        if (n == -1) {
+            perror(argv[i]);
+            position_free_paths(paths, count);
+            return EXIT_FAILURE;
+        }
+        count = n;
+    }
+
+    analyze_totals_t tot = {0};
+    for (int i = 0; i < count; i++) {
+        analyze_position(paths[i], &o, &tot);
+        if (i + 1 < count) printf("\n");
+    }
+    position_free_paths(paths, count);
+
+    if (tot.positions > 1) {
+        printf("\n== total: %d posiciones, %.0f nodos/s", tot.positions,
+               tot.wall_ns ? tot.nodes * 1e9 / (double)tot.wall_ns : 0.0);
+        if (tot.comparable) printf(", coincidencia con la partida %.1f%%", 100.0 * tot.agree / tot.comparable);
+        printf("\n");
+    }
+    return tot.positions > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
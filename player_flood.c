@@ -0,0 +1,203 @@
+#include "common.h"
+#include "shm_manager.h"
+#include "sim.h"
+#include "rwsync.h"
+#include "turnwait.h"
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <stdbool.h>
+
+// Jugador generador de carga: responde cada token al instante, siguiendo un
+// recorrido precalculado (Warnsdorff sobre su copia del tablero). Con
+// CHOMP_FLOOD_INVALID=<0..1> manda esa proporción de jugadas inválidas.
+
+typedef struct {
+    int width;
+    int height;
+    int *board;
+    unsigned char *walk;
+    int walk_len;
+    int walk_pos;
+    int exp_x, exp_y;
+} flood_t;
+
+static int find_my_index(game_state_t *gs, game_sync_t *sync) {
+    pid_t me = getpid();
+    int idx = -1;
+
+    reader_enter(sync);
+    for (unsigned int i = 0; i < gs->player_count; i++) {
+        if ((pid_t)gs->players[i].pid == me) {
+            idx = (int)i;
+            break;
+        }
+    }
+    reader_exit(sync);
+    return idx;
+}
+
+static bool free_cell(const flood_t *f, int x, int y) {
+    return x >= 0 && x < f->width && y >= 0 && y < f->height && f->board[y * f->width + x] > 0;
+}
+
+static int degree(const flood_t *f, int x, int y) {
+    int n = 0;
+    for (int d = 0; d < 8; d++) {
+        int tx, ty;
+        game_target_from_dir(x, y, d, &tx, &ty);
+        if (free_cell(f, tx, ty)) n++;
+    }
+    return n;
+}
+
+// Recalcula el recorrido desde (x, y) sobre f->board (que se consume).
+static void plan_walk(flood_t *f, int x, int y) {
+    f->walk_len = 0;
+    f->walk_pos = 0;
+    f->exp_x = x;
+    f->exp_y = y;
+    int cells = f->width * f->height;
+    while (f->walk_len < cells) {
+        int best = -1, best_deg = 9;
+        for (int d = 0; d < 8; d++) {
+            int tx, ty;
+            game_target_from_dir(x, y, d, &tx, &ty);
+            if (!free_cell(f, tx, ty)) continue;
+            f->board[ty * f->width + tx] = 0;
+            int dg = degree(f, tx, ty);
+            f->board[ty * f->width + tx] = 1;
+            if (dg < best_deg) {
+                best_deg = dg;
+                best = d;
+            }
+        }
+        if (best == -1) break;
+        game_target_from_dir(x, y, best, &x, &y);
+        f->board[y * f->width + x] = 0;
+        f->walk[f->walk_len++] = (unsigned char)best;
+    }
+}
+
+// Elige la próxima jugada; -1 si no queda ninguna válida. Llamar con el lock de lector.
+static int next_move(flood_t *f, const game_state_t *gs, int my_index) {
+    int x = (int)gs->players[my_index].x;
+    int y = (int)gs->players[my_index].y;
+    if (x != f->exp_x || y != f->exp_y || f->walk_pos >= f->walk_len) {
+        memcpy(f->board, gs->board, sizeof(int) * f->width * f->height);
+        plan_walk(f, x, y);
+    }
+    if (f->walk_pos >= f->walk_len) return -1;
+    int d = f->walk[f->walk_pos];
+    int tx, ty;
+    game_target_from_dir(x, y, d, &tx, &ty);
+    if (tx < 0 || tx >= f->width || ty < 0 || ty >= f->height || gs->board[ty * f->width + tx] <= 0) {
+        // Otro jugador tomó la celda: se replanifica sobre el tablero actual.
+        memcpy(f->board, gs->board, sizeof(int) * f->width * f->height);
+        plan_walk(f, x, y);
+        if (f->walk_len == 0) return -1;
+        d = f->walk[0];
+        game_target_from_dir(x, y, d, &tx, &ty);
+    }
+    f->walk_pos++;
+    f->exp_x = tx;
+    f->exp_y = ty;
+    return d;
+}
+
+// Una dirección que choca con un borde o una celda tomada, o un byte fuera de rango.
+static unsigned char invalid_move(const game_state_t *gs, int my_index) {
+    int x = (int)gs->players[my_index].x;
+    int y = (int)gs->players[my_index].y;
+    for (int d = 0; d < 8; d++) {
+        int tx, ty;
+        game_target_from_dir(x, y, d, &tx, &ty);
+        if (tx < 0 || tx >= gs->width || ty < 0 || ty >= gs->height || gs->board[ty * gs->width + tx] <= 0) {
+            return (unsigned char)d;
+        }
+    }
+    return 8;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Uso: %s <ancho> <alto>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int width = atoi(argv[1]);
+    int height = atoi(argv[2]);
+    const char *ratio_env = getenv("CHOMP_FLOOD_INVALID");
+    double invalid_ratio = ratio_env ? atof(ratio_env) : 0.0;
+    unsigned int invalid_threshold = invalid_ratio <= 0.0 ? 0 : invalid_ratio >= 1.0 ? UINT_MAX : (unsigned int)(invalid_ratio * UINT_MAX);
+    unsigned int rng = (unsigned int)getpid() * 2654435761u;
+
+    shm_manager_t *state_mgr = shm_manager_open(SHM_GAME_STATE, 0, 0);
+    if (!state_mgr) {
+        perror("shm_manager_open state");
+        return EXIT_FAILURE;
+    }
+    game_state_t *game_state = (game_state_t *)shm_manager_data(state_mgr);
+    shm_manager_t *sync_mgr = shm_manager_open(SHM_GAME_SYNC, 0, 0);
+    if (!sync_mgr) {
+        perror("shm_manager_open sync");
+        shm_manager_close(state_mgr);
+        return EXIT_FAILURE;
+    }
+    game_sync_t *game_sync = (game_sync_t *)shm_manager_data(sync_mgr);
+
+    int my_index = -1;
+    for (int it = 0; it < 500 && my_index == -1 && !game_state->game_over; it++) {
+        my_index = find_my_index(game_state, game_sync);
+        if (my_index != -1) break;
+        struct timespec short_sleep = {0, 10 * 1000 * 1000};
+        nanosleep(&short_sleep, NULL);
+    }
+    if (my_index == -1) {
+        fprintf(stderr, "player_flood: couldn't determine my index (pid %d)\n", (int)getpid());
+        shm_manager_close(state_mgr);
+        shm_manager_close(sync_mgr);
+        return EXIT_FAILURE;
+    }
+
+    flood_t f = { .width = width, .height = height, .exp_x = -1, .exp_y = -1 };
+    f.board = malloc(sizeof(int) * width * height);
+    f.walk = malloc((size_t)width * height);
+    if (!f.board || !f.walk) {
+        fprintf(stderr, "allocation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    const char *spin_env = getenv("CHOMP_SPIN_US");
+    turn_spin_t spin;
+    turn_spin_init(&spin, game_sync, my_index, spin_env ? (unsigned int)atoi(spin_env) : 0);
+
+    while (1) {
+        if (turn_wait(&spin, game_sync, my_index) == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (game_state->game_over || game_state->players[my_index].blocked) break;
+
+        reader_enter(game_sync);
+        int pick;
+        if (invalid_threshold && sim_rng_next(&rng) <= invalid_threshold) {
+            pick = invalid_move(game_state, my_index);
+        } else {
+            pick = next_move(&f, game_state, my_index);
+        }
+        reader_exit(game_sync);
+        if (pick == -1) break;
+
+        unsigned char move = (unsigned char)pick;
+        if (write(STDOUT_FILENO, &move, 1) != 1) break;
+    }
+
+    free(f.board);
+    free(f.walk);
+    shm_manager_close(state_mgr);
+    shm_manager_close(sync_mgr);
+    return EXIT_SUCCESS;
+}
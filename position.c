@@ -0,0 +1,156 @@
+#include "position.h"
+#include <dirent.h>
+
+int position_from_state(position_t *pos, const game_state_t *gs, int to_move, int played) {
+    memset(pos, 0, sizeof(*pos));
+    int cells = gs->width * gs->height;
+    pos->board = malloc(sizeof(int) * cells);
+    if (!pos->board) return -1;
+    pos->width = gs->width;
+    pos->height = gs->height;
+    pos->player_count = (int)gs->player_count;
+    pos->to_move = to_move;
+    pos->played = played;
+    for (int i = 0; i < pos->player_count; i++) {
+        pos->players[i].x = gs->players[i].x;
+        pos->players[i].y = gs->players[i].y;
+        pos->players[i].score = gs->players[i].score;
+        pos->players[i].blocked = gs->players[i].blocked;
+    }
+    memcpy(pos->board, gs->board, sizeof(int) * cells);
+    return 0;
+}
+
+static int malformed(FILE *in, position_t *pos) {
+    fclose(in);
+    position_free(pos);
+    errno = EINVAL;
+    return -1;
+}
+
+int position_load(const char *path, position_t *pos) {
+    memset(pos, 0, sizeof(*pos));
+    pos->played = -1;
+    FILE *in = fopen(path, "r");
+    if (!in) return -1;
+
+    char magic[32];
+    int version;
+    if (fscanf(in, "%31s %d", magic, &version) != 2 || strcmp(magic, POSITION_MAGIC) != 0 || version != POSITION_VERSION) {
+        return malformed(in, pos);
+    }
+    char key[16];
+    int seen_players = 0;
+    bool seen[MAX_PLAYERS] = {false};
+    while (fscanf(in, "%15s", key) == 1) {
+        if (strcmp(key, "size") == 0) {
+            if (fscanf(in, "%d %d", &pos->width, &pos->height) != 2) return malformed(in, pos);
+        } else if (strcmp(key, "players") == 0) {
+            if (fscanf(in, "%d", &pos->player_count) != 1) return malformed(in, pos);
+        } else if (strcmp(key, "to_move") == 0) {
+            if (fscanf(in, "%d", &pos->to_move) != 1) return malformed(in, pos);
+        } else if (strcmp(key, "played") == 0) {
+            if (fscanf(in, "%d", &pos->played) != 1) return malformed(in, pos);
+        } else if (strcmp(key, "player") == 0) {
+            int i, x, y, blocked;
+            unsigned int score;
+            if (fscanf(in, "%d %d %d %u %d", &i, &x, &y, &score, &blocked) != 5) return malformed(in, pos);
+            if (i < 0 || i >= MAX_PLAYERS || seen[i]) return malformed(in, pos);
+            pos->players[i] = (sim_player_t){ x, y, score, blocked != 0 };
+            seen[i] = true;
+            seen_players++;
+        } else if (strcmp(key, "board") == 0) {
+            break;
+        } else {
+            return malformed(in, pos);
+        }
+    }
+    // Las dimensiones acotadas por SIM_MAX_SIDE no desbordan width * height.
+    if (pos->width <= 0 || pos->height <= 0 || pos->width > SIM_MAX_SIDE || pos->height > SIM_MAX_SIDE ||
+        pos->player_count <= 0 || pos->player_count > MAX_PLAYERS || seen_players != pos->player_count ||
+        pos->to_move < 0 || pos->to_move >= pos->player_count || pos->played < -1 || pos->played > 7) {
+        return malformed(in, pos);
+    }
+    for (int i = 0; i < pos->player_count; i++) {
+        const sim_player_t *p = &pos->players[i];
+        if (!seen[i] || p->x < 0 || p->x >= pos->width || p->y < 0 || p->y >= pos->height) return malformed(in, pos);
+    }
+    int cells = pos->width * pos->height;
+    pos->board = malloc(sizeof(int) * cells);
+    if (!pos->board) {
+        fclose(in);
+        return -1;
+    }
+    for (int i = 0; i < cells; i++) {
+        if (fscanf(in, "%d", &pos->board[i]) != 1) return malformed(in, pos);
+    }
+    fclose(in);
+    return 0;
+}
+
+int position_save(const char *path, const position_t *pos) {
+    FILE *out = fopen(path, "w");
+    if (!out) return -1;
+    fprintf(out, "%s %d\nsize %d %d\nplayers %d\nto_move %d\nplayed %d\n",
+            POSITION_MAGIC, POSITION_VERSION, pos->width, pos->height, pos->player_count, pos->to_move, pos->played);
+    for (int i = 0; i < pos->player_count; i++) {
+        const sim_player_t *p = &pos->players[i];
+        fprintf(out, "player %d %d %d %u %d\n", i, p->x, p->y, p->score, p->blocked ? 1 : 0);
+    }
+    fprintf(out, "board\n");
+    for (int y = 0; y < pos->height; y++) {
+        for (int x = 0; x < pos->width; x++) {
+            fprintf(out, "%s%d", x ? " " : "", pos->board[y * pos->width + x]);
+        }
+        fputc('\n', out);
+    }
+    return fclose(out);
+}
+
+void position_free(position_t *pos) {
+    free(pos->board);
+    pos->board = NULL;
+}
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int push_path(char ***paths, int count, const char *path) {
+    char **grown = realloc(*paths, sizeof(char *) * (count + 1));
+    if (!grown) return -1;
+    *paths = grown;
+    grown[count] = strdup(path);
+    return grown[count] ? count + 1 : -1;
+}
+
+int position_collect(const char *path, char ***paths, int count) {
+    struct stat st;
+    if (stat(path, &st) == -1) return -1;
+    if (!S_ISDIR(st.st_mode)) return push_path(paths, count, path);
+
+    DIR *dir = opendir(path);
+    if (!dir) return -1;
+    int first = count;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        size_t len = strlen(de->d_name);
+        if (len < 5 || strcmp(de->d_name + len - 4, ".pos") != 0) continue;
+        char full[PATH_MAX];
+        snprintf(full, sizeof(full), "%s/%s", path, de->d_name);
+        int n = push_path(paths, count, full);
+        if (n == -1) {
+            closedir(dir);
+            return -1;
+        }
+        count = n;
+    }
+    closedir(dir);
+    qsort(*paths + first, count - first, sizeof(char *), cmp_str);
+    return count;
+}
+
+void position_free_paths(char **paths, int count) {
+    for (int i = 0; i < count; i++) free(paths[i]);
+    free(paths);
+}
@@ -0,0 +1,44 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "common.h"
+#include "sim.h"
+
+// Posición suelta para benchmarks y análisis offline, en texto:
+//
+//   chomp-position 1
+//   size <ancho> <alto>
+//   players <n>
+//   to_move <i>
+//   played <dir>                 (opcional: la jugada hecha en la partida, -1 si no se sabe)
+//   player <i> <x> <y> <puntaje> <bloqueado>
+//   board
+//   <alto filas de ancho enteros: >0 recompensa libre, <=0 celda tomada>
+#define POSITION_MAGIC "chomp-position"
+#define POSITION_VERSION 1
+
+typedef struct {
+    int width;
+    int height;
+    int player_count;
+    int to_move;
+    int played;
+    sim_player_t players[MAX_PLAYERS];
+    int *board;
+} position_t;
+
+// Copia el estado (llamar con el lock de lectura o de escritura tomado).
+int position_from_state(position_t *pos, const game_state_t *gs, int to_move, int played);
+
+// Devuelven 0 o -1 con errno (EINVAL si el archivo está mal formado).
+int position_load(const char *path, position_t *pos);
+int position_save(const char *path, const position_t *pos);
+
+void position_free(position_t *pos);
+
+// Expande path: si es un directorio, sus *.pos ordenados por nombre; si no, el
+// propio path. Agrega a *paths (realloc) y devuelve la nueva cantidad, o -1.
+int position_collect(const char *path, char ***paths, int count);
+void position_free_paths(char **paths, int count);
+
+#endif
@@ -0,0 +1,969 @@
+#define _DEFAULT_SOURCE
+#include "referee.h"
+#include "game.h"
+#include "trace.h"
+#include "metrics.h"
+#include "telemetry.h"
+#include "position.h"
+#include "turnwait.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+
+int referee_sync_init(game_sync_t *game_sync) {
+    if (sem_init(&game_sync->master_to_view, 1, 0) == -1) { perror("sem_init master_to_view"); return -1; }
+    if (sem_init(&game_sync->view_to_master, 1, 0) == -1) { perror("sem_init view_to_master"); return -1; }
+    if (sem_init(&game_sync->master_mutex, 1, 1) == -1) { perror("sem_init master_mutex"); return -1; }
+    if (sem_init(&game_sync->state_mutex, 1, 1) == -1) { perror("sem_init state_mutex"); return -1; }
+    if (sem_init(&game_sync->reader_count_mutex, 1, 1) == -1) { perror("sem_init reader_count_mutex"); return -1; }
+    game_sync->reader_count = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        atomic_init(&game_sync->turn_seq[i], 0);
+        atomic_init(&game_sync->turn_release_ns[i], 0);
+    }
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (sem_init(&game_sync->player_mutex[i], 1, 0) == -1) { perror("sem_init player_mutex"); return -1; }
+    }
+    return 0;
+}
+
+void referee_sync_destroy(game_sync_t *game_sync) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+      
+        sem_post(&game_sync->player_mutex[i]);
+    }
+
+    sem_post(&game_sync->master_to_view);
+    sem_post(&game_sync->view_to_master);
+
+    if (sem_destroy(&game_sync->master_to_view) == -1) {
+        perror("sem_destroy master_to_view");
+    }
+    if (sem_destroy(&game_sync->view_to_master) == -1) {
+        perror("sem_destroy view_to_master");
+    }
+    if (sem_destroy(&game_sync->master_mutex) == -1) {
+        perror("sem_destroy master_mutex");
+    }
+    if (sem_destroy(&game_sync->state_mutex) == -1) {
+        perror("sem_destroy state_mutex");
+    }
+    if (sem_destroy(&game_sync->reader_count_mutex) == -1) {
+        perror("sem_destroy reader_count_mutex");
+    }
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (sem_destroy(&game_sync->player_mutex[i]) == -1) {
+            perror("sem_destroy player_mutex");
+        }
+    }
+}
+
+static uint64_t master_acquired_ns;
+static uint64_t state_acquired_ns;
+
+static int lock_master(game_sync_t *sync) {
+    uint64_t t0 = metrics_now_ns();
+    // Un pedido de métricas (SIGUSR1) no puede hacer perder la jugada ya leída.
+    while (sem_wait(&sync->master_mutex) == -1) {
+        if (errno != EINTR) return -1;
+    }
+    master_acquired_ns = metrics_now_ns();
+    hist_record(&referee_metrics.master_mutex_wait, master_acquired_ns - t0);
+    return 0;
+}
+
+static int unlock_master(game_sync_t *sync) {
+    hist_record(&referee_metrics.master_mutex_hold, metrics_now_ns() - master_acquired_ns);
+    return sem_post(&sync->master_mutex);
+}
+
+static int lock_state(game_sync_t *sync) {
+    uint64_t t0 = metrics_now_ns();
+    while (sem_wait(&sync->state_mutex) == -1) {
+        if (errno != EINTR) return -1;
+    }
+    state_acquired_ns = metrics_now_ns();
+    hist_record(&referee_metrics.state_mutex_wait, state_acquired_ns - t0);
+    return 0;
+}
+
+static int unlock_state(game_sync_t *sync) {
+    hist_record(&referee_metrics.state_mutex_hold, metrics_now_ns() - state_acquired_ns);
+    return sem_post(&sync->state_mutex);
+}
+
+static void publish_move(bool valid) {
+    static unsigned int published = 0;
+    if (!telemetry) return;
+    if (valid) atomic_fetch_add_explicit(&telemetry->moves_valid, 1, memory_order_relaxed);
+    else atomic_fetch_add_explicit(&telemetry->moves_invalid, 1, memory_order_relaxed);
+    atomic_store_explicit(&telemetry->lock_wait_ns,
+                          referee_metrics.master_mutex_wait.sum + referee_metrics.state_mutex_wait.sum,
+                          memory_order_relaxed);
+    if ((published++ & 63) == 0) atomic_store_explicit(&telemetry->rss_kb, telemetry_rss_kb(), memory_order_relaxed);
+    atomic_store_explicit(&telemetry->updated_ns, metrics_now_ns(), memory_order_relaxed);
+}
+
+static bool should_dump(const referee_t *r, int move_no) {
+    if (!r->dump_dir) return false;
+    if (r->dump_every > 0) return move_no % r->dump_every == 0;
+    for (int i = 0; i < r->dump_move_count; i++) {
+        if (r->dump_moves[i] == move_no) return true;
+    }
+    return false;
+}
+
+static void dump_position(const referee_t *r, position_t *pos, int move_no) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/s%u_m%05d.pos", r->dump_dir, r->dump_tag, move_no);
+    if (position_save(path, pos) == -1) perror(path);
+    position_free(pos);
+}
+
+// Todo lo que despierta al master es un fd en epoll: pipes de los jugadores,
+// pidfds de los hijos, un eventfd con los acks de la vista (un hilo puente
+// traduce sem_wait(view_to_master) a escrituras) y timerfds para la pausa
+// entre jugadas y el timeout. ep_gated se usa mientras la vista dibuja o
+// durante la pausa: tiene los de control y los pipes en EPOLLONESHOT, que sólo
+// avisan una vez para encolar al jugador (se rearman al leer su jugada).
+enum { EV_PIPE = 1, EV_PIDFD, EV_VIEW_PIDFD, EV_VIEW_ACK, EV_PACE, EV_TIMEOUT, EV_DEADLINE };
+#define EV_TAG(kind, i) (((uint64_t)(kind) << 32) | (uint32_t)(i))
+
+typedef struct {
+    int ep_open;
+    int ep_gated;
+    int pace_fd;
+    int timeout_fd;
+    int deadline_fd;
+    int view_ack_fd;
+    int view_pidfd;
+    int pidfds[MAX_PLAYERS];
+    bool exited[MAX_PLAYERS];
+    game_sync_t *sync;
+    pthread_t bridge;
+    bool bridge_running;
+    _Atomic bool bridge_stop;
+    bool view_pending;
+    int view_turn;
+    uint64_t view_t0;
+    bool pacing;
+    // Reloj de cada jugador desde que recibe el token (-b/-B).
+    uint64_t turn_start_ns[MAX_PLAYERS];
+    int64_t bank_ns[MAX_PLAYERS];
+    bool on_clock[MAX_PLAYERS];
+    bool overdue[MAX_PLAYERS];
+} referee_events_t;
+
+static int pidfd_open_compat(pid_t pid) {
+#ifdef SYS_pidfd_open
+    if (pid <= 0) return -1;
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+static int ev_add(referee_events_t *ev, int fd, uint64_t tag, bool control) {
+    struct epoll_event e = { .events = EPOLLIN, .data.u64 = tag };
+    if (epoll_ctl(ev->ep_open, EPOLL_CTL_ADD, fd, &e) == -1) return -1;
+    if (!control) e.events |= EPOLLONESHOT;
+    return epoll_ctl(ev->ep_gated, EPOLL_CTL_ADD, fd, &e);
+}
+
+static void ev_rearm_pipe(referee_events_t *ev, int fd, int i) {
+    struct epoll_event e = { .events = EPOLLIN | EPOLLONESHOT, .data.u64 = EV_TAG(EV_PIPE, i) };
+    epoll_ctl(ev->ep_gated, EPOLL_CTL_MOD, fd, &e);
+}
+
+static void ev_close(referee_events_t *ev, int *fd) {
+    if (*fd == -1) return;
+    epoll_ctl(ev->ep_open, EPOLL_CTL_DEL, *fd, NULL);
+    epoll_ctl(ev->ep_gated, EPOLL_CTL_DEL, *fd, NULL);
+    close(*fd);
+    *fd = -1;
+}
+
+static void *view_ack_bridge(void *arg) {
+    referee_events_t *ev = arg;
+    uint64_t one = 1;
+    for (;;) {
+        if (sem_wait(&ev->sync->view_to_master) == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (atomic_load(&ev->bridge_stop)) break;
+        if (write(ev->view_ack_fd, &one, sizeof(one)) != (ssize_t)sizeof(one)) break;
+    }
+    return NULL;
+}
+
+static void arm_timer_ns(int fd, uint64_t ns, int flags) {
+    struct itimerspec its = { .it_value = { (time_t)(ns / 1000000000ull), (long)(ns % 1000000000ull) } };
+    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) its.it_value.tv_nsec = 1;
+    timerfd_settime(fd, flags, &its, NULL);
+}
+
+static void drain_fd(int fd) {
+    uint64_t v;
+    if (read(fd, &v, sizeof(v)) == -1 && errno != EAGAIN) perror("read timerfd/eventfd");
+}
+
+static int events_open(referee_events_t *ev, referee_t *r, pid_t view_pid) {
+    memset(ev, 0, sizeof(*ev));
+    ev->sync = r->sync;
+    ev->pace_fd = ev->timeout_fd = ev->deadline_fd = ev->view_ack_fd = ev->view_pidfd = -1;
+    for (int i = 0; i < MAX_PLAYERS; i++) ev->pidfds[i] = -1;
+    ev->view_turn = -1;
+
+    ev->ep_open = epoll_create1(EPOLL_CLOEXEC);
+    ev->ep_gated = epoll_create1(EPOLL_CLOEXEC);
+    ev->pace_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    ev->timeout_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    ev->deadline_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (ev->ep_open == -1 || ev->ep_gated == -1 || ev->pace_fd == -1 || ev->timeout_fd == -1 || ev->deadline_fd == -1) {
+        perror("epoll/timerfd");
+        return -1;
+    }
+    for (int i = 0; i < MAX_PLAYERS; i++) ev->bank_ns[i] = (int64_t)r->bank_ms * 1000000;
+    if (ev_add(ev, ev->pace_fd, EV_TAG(EV_PACE, 0), true) == -1 ||
+        ev_add(ev, ev->timeout_fd, EV_TAG(EV_TIMEOUT, 0), true) == -1 ||
+        ev_add(ev, ev->deadline_fd, EV_TAG(EV_DEADLINE, 0), true) == -1) {
+        perror("epoll_ctl timerfd");
+        return -1;
+    }
+    for (int i = 0; i < r->player_count; i++) {
+        if (r->pipes[i][PIPE_READ] != -1 && ev_add(ev, r->pipes[i][PIPE_READ], EV_TAG(EV_PIPE, i), false) == -1) {
+            perror("epoll_ctl pipe");
+            return -1;
+        }
+        // Sin pidfd (kernel viejo) alcanza con el EOF del pipe.
+        ev->pidfds[i] = pidfd_open_compat(r->state->players[i].pid);
+        if (ev->pidfds[i] != -1) ev_add(ev, ev->pidfds[i], EV_TAG(EV_PIDFD, i), true);
+    }
+    if (r->with_view) {
+        ev->view_ack_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (ev->view_ack_fd == -1 || ev_add(ev, ev->view_ack_fd, EV_TAG(EV_VIEW_ACK, 0), true) == -1) {
+            perror("eventfd view");
+            return -1;
+        }
+        ev->view_pidfd = pidfd_open_compat(view_pid);
+        if (ev->view_pidfd != -1) ev_add(ev, ev->view_pidfd, EV_TAG(EV_VIEW_PIDFD, 0), true);
+        if (pthread_create(&ev->bridge, NULL, view_ack_bridge, ev) != 0) {
+            perror("pthread_create view bridge");
+            return -1;
+        }
+        ev->bridge_running = true;
+    }
+    return 0;
+}
+
+static void events_close(referee_events_t *ev) {
+    if (ev->bridge_running) {
+        atomic_store(&ev->bridge_stop, true);
+        sem_post(&ev->sync->view_to_master);
+        pthread_join(ev->bridge, NULL);
+    }
+    ev_close(ev, &ev->pace_fd);
+    ev_close(ev, &ev->timeout_fd);
+    ev_close(ev, &ev->deadline_fd);
+    ev_close(ev, &ev->view_ack_fd);
+    ev_close(ev, &ev->view_pidfd);
+    for (int i = 0; i < MAX_PLAYERS; i++) ev_close(ev, &ev->pidfds[i]);
+    if (ev->ep_open != -1) close(ev->ep_open);
+    if (ev->ep_gated != -1) close(ev->ep_gated);
+}
+
+// Solo el master escribe el estado, así que puede leerlo sin tomar el lock.
+static bool has_valid_move(const game_state_t *gs, int i) {
+    for (int d = 0; d < 8; d++) {
+        if (game_is_valid_move_locked(gs, i, (direction_t)d)) return true;
+    }
+    return false;
+}
+
+static uint64_t deadline_of(const referee_t *r, const referee_events_t *ev, int i) {
+    int64_t bank = ev->bank_ns[i] > 0 ? ev->bank_ns[i] : 0;
+    return ev->turn_start_ns[i] + (uint64_t)r->move_budget_ms * 1000000ull + (uint64_t)bank;
+}
+
+// Arma el timer con el plazo más cercano entre los jugadores que tienen el token.
+static void arm_deadline(referee_t *r, referee_events_t *ev) {
+    if (r->move_budget_ms <= 0) return;
+    uint64_t next = 0;
+    for (int i = 0; i < r->player_count; i++) {
+        if (!ev->on_clock[i] || ev->overdue[i]) continue;
+        uint64_t d = deadline_of(r, ev, i);
+        if (next == 0 || d < next) next = d;
+    }
+    struct itimerspec its = {0};
+    if (next) its.it_value = (struct timespec){ (time_t)(next / 1000000000ull), (long)(next % 1000000000ull) };
+    timerfd_settime(ev->deadline_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void start_clock(referee_t *r, referee_events_t *ev, int i) {
+    ev->turn_start_ns[i] = metrics_now_ns();
+    ev->on_clock[i] = true;
+    ev->overdue[i] = false;
+    arm_deadline(r, ev);
+}
+
+// Registra el tiempo de pensar y descuenta del banco lo que se pasó del plazo por jugada.
+static void stop_clock(referee_t *r, referee_events_t *ev, int i, uint64_t now) {
+    if (!ev->on_clock[i]) return;
+    uint64_t used = now - ev->turn_start_ns[i];
+    hist_record(&referee_metrics.think_time[i], used);
+    uint64_t budget = (uint64_t)r->move_budget_ms * 1000000ull;
+    if (r->move_budget_ms > 0 && used > budget) ev->bank_ns[i] -= (int64_t)(used - budget);
+    ev->on_clock[i] = false;
+}
+
+// Devuelve el turno al jugador y arranca la pausa entre jugadas.
+static void release_turn(referee_t *r, referee_events_t *ev, int i) {
+    turn_release(r->sync, i);
+    start_clock(r, ev, i);
+    if (r->delay_ms > 0) {
+        arm_timer_ns(ev->pace_fd, (uint64_t)r->delay_ms * 1000000ull, 0);
+        ev->pacing = true;
+    }
+}
+
+static void view_done(referee_t *r, referee_events_t *ev) {
+    if (!ev->view_pending) return;
+    hist_record(&referee_metrics.view_handshake, metrics_now_ns() - ev->view_t0);
+    ev->view_pending = false;
+    release_turn(r, ev, ev->view_turn);
+    ev->view_turn = -1;
+}
+
+static int player_gone(referee_t *r, int i) {
+    if (lock_master(r->sync) == -1) {
+        perror("sem_wait master_mutex");
+        return -1;
+    }
+    if (lock_state(r->sync) == -1) {
+        perror("sem_wait state_mutex");
+        unlock_master(r->sync);
+        return -1;
+    }
+    r->state->players[i].blocked = true;
+    close(r->pipes[i][PIPE_READ]);
+    r->pipes[i][PIPE_READ] = -1;
+    unlock_state(r->sync);
+    unlock_master(r->sync);
+    return 0;
+}
+
+static bool pipe_has_data(int fd) {
+    int avail = 0;
+    return fd != -1 && ioctl(fd, FIONREAD, &avail) == 0 && avail > 0;
+}
+
+static int set_game_over(game_sync_t *sync, game_state_t *gs) {
+    if (lock_master(sync) == -1) { perror("sem_wait master_mutex"); return -1; }
+    if (lock_state(sync) == -1) { perror("sem_wait state_mutex"); unlock_master(sync); return -1; }
+    gs->game_over = true;
+    unlock_state(sync);
+    unlock_master(sync);
+    return 0;
+}
+
+// Atiende un evento de control; devuelve true si venció el timeout global.
+static bool handle_control(referee_t *r, referee_events_t *ev, uint64_t tag, uint64_t last_valid_ns) {
+    int kind = (int)(tag >> 32);
+    int i = (int)(uint32_t)tag;
+    uint64_t timeout_ns = (uint64_t)r->timeout_sec * 1000000000ull;
+    switch (kind) {
+        case EV_PACE:
+            drain_fd(ev->pace_fd);
+            ev->pacing = false;
+            break;
+        case EV_TIMEOUT: {
+            drain_fd(ev->timeout_fd);
+            uint64_t now = metrics_now_ns();
+            if (now - last_valid_ns >= timeout_ns) return true;
+            arm_timer_ns(ev->timeout_fd, last_valid_ns + timeout_ns - now, 0);
+            break;
+        }
+        case EV_DEADLINE: {
+            drain_fd(ev->deadline_fd);
+            uint64_t now = metrics_now_ns();
+            for (int p = 0; p < r->player_count; p++) {
+                if (!ev->on_clock[p] || ev->overdue[p] || ev->exited[p] || r->state->players[p].blocked) continue;
+                if (deadline_of(r, ev, p) > now || !has_valid_move(r->state, p)) continue;
+                // Si la jugada ya está en el pipe llegó a tiempo (el master estaba esperando a la vista).
+                if (r->pipes[p][PIPE_READ] == -1 || pipe_has_data(r->pipes[p][PIPE_READ])) continue;
+                ev->overdue[p] = true;
+                referee_metrics.overdue[p]++;
+                if (r->overdue_blocks) player_gone(r, p);
+            }
+            arm_deadline(r, ev);
+            break;
+        }
+        case EV_VIEW_ACK:
+            drain_fd(ev->view_ack_fd);
+            view_done(r, ev);
+            break;
+        case EV_VIEW_PIDFD:
+            // La vista murió: no va a haber más acks.
+            ev_close(ev, &ev->view_pidfd);
+            r->with_view = false;
+            view_done(r, ev);
+            break;
+        case EV_PIDFD:
+            ev_close(ev, &ev->pidfds[i]);
+            ev->exited[i] = true;
+            if (r->pipes[i][PIPE_READ] != -1 && !pipe_has_data(r->pipes[i][PIPE_READ])) player_gone(r, i);
+            break;
+        default:
+            break;
+    }
+    return false;
+}
+
+// Jugadores con jugada pendiente, en orden de llegada. Los que aparecen en el
+// mismo epoll_wait se encolan rotando desde el siguiente al último atendido,
+// así ningún índice queda siempre primero cuando la vista o -d frenan el bucle.
+typedef struct {
+    int slot[MAX_PLAYERS];
+    int head;
+    int count;
+    int rr;
+    bool queued[MAX_PLAYERS];
+    uint64_t since_ns[MAX_PLAYERS];
+} ready_queue_t;
+
+static void rq_push(ready_queue_t *q, int i, uint64_t now) {
+    if (q->queued[i]) return;
+    q->slot[(q->head + q->count) % MAX_PLAYERS] = i;
+    q->count++;
+    q->queued[i] = true;
+    q->since_ns[i] = now;
+}
+
+static int rq_pop(ready_queue_t *q, int player_count) {
+    int i = q->slot[q->head];
+    q->head = (q->head + 1) % MAX_PLAYERS;
+    q->count--;
+    q->queued[i] = false;
+    q->rr = (i + 1) % player_count;
+    return i;
+}
+
+// Árbitro con varios hilos (referee_t.workers > 1). El hilo w atiende los
+// pipes de los jugadores con i % workers == w y es el único que escribe sus
+// registros, así que esos no llevan lock. El tablero se parte en regiones de
+// 16x16 con un mutex cada una: aplicar una jugada escribe sólo la celda
+// destino y toma sólo su región; mirar las vecinas de un jugador puede cruzar
+// hasta 4 regiones, que se toman siempre en orden de índice. Frente a los
+// lectores (jugadores y vista) los hilos son un solo escritor: el primero que
+// entra toma master_mutex y state_mutex y el último que sale los suelta.
+#define SHARD_TILE_SHIFT 4
+
+typedef struct {
+    referee_t *r;
+    int workers;
+    int tiles_x;
+    pthread_mutex_t *tiles;
+    pthread_mutex_t group_lock;
+    int inside;
+    int stop_fd;
+    // x | y << 16, para que otros hilos lean la posición sin tomar el registro.
+    _Atomic uint32_t pos[MAX_PLAYERS];
+    atomic_bool finished[MAX_PLAYERS];
+    atomic_int finished_count;
+    _Atomic uint64_t last_valid_ns;
+    atomic_bool failed;
+} shard_t;
+
+typedef struct {
+    shard_t *s;
+    int id;
+    pthread_t tid;
+} shard_worker_t;
+
+static void shard_stop(shard_t *s) {
+    uint64_t one = 1;
+    if (write(s->stop_fd, &one, sizeof(one)) == -1) perror("write stop_fd");
+}
+
+static void shard_fail(shard_t *s) {
+    atomic_store(&s->failed, true);
+    shard_stop(s);
+}
+
+static int shard_enter(shard_t *s) {
+    int rc = 0;
+    pthread_mutex_lock(&s->group_lock);
+    if (s->inside == 0) {
+        if (lock_master(s->r->sync) == -1) {
+            perror("sem_wait master_mutex");
+            rc = -1;
+        } else if (lock_state(s->r->sync) == -1) {
+            perror("sem_wait state_mutex");
+            unlock_master(s->r->sync);
+            rc = -1;
+        }
+    }
+    if (rc == 0) s->inside++;
+    pthread_mutex_unlock(&s->group_lock);
+    return rc;
+}
+
+// ready_ns != 0 registra la jugada (las métricas globales van bajo group_lock).
+static void shard_leave(shard_t *s, uint64_t ready_ns, bool valid) {
+    pthread_mutex_lock(&s->group_lock);
+    if (ready_ns) {
+        hist_record(&referee_metrics.ready_to_apply, metrics_now_ns() - ready_ns);
+        publish_move(valid);
+    }
+    if (--s->inside == 0) {
+        unlock_state(s->r->sync);
+        unlock_master(s->r->sync);
+    }
+    pthread_mutex_unlock(&s->group_lock);
+}
+
+static pthread_mutex_t *shard_tile(shard_t *s, int x, int y) {
+    return &s->tiles[(y >> SHARD_TILE_SHIFT) * s->tiles_x + (x >> SHARD_TILE_SHIFT)];
+}
+
+static void shard_lock_around(shard_t *s, int x, int y, bool lock) {
+    const game_state_t *gs = s->r->state;
+    int tx0 = (x > 0 ? x - 1 : x) >> SHARD_TILE_SHIFT;
+    int tx1 = (x + 1 < gs->width ? x + 1 : x) >> SHARD_TILE_SHIFT;
+    int ty0 = (y > 0 ? y - 1 : y) >> SHARD_TILE_SHIFT;
+    int ty1 = (y + 1 < gs->height ? y + 1 : y) >> SHARD_TILE_SHIFT;
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            pthread_mutex_t *m = &s->tiles[ty * s->tiles_x + tx];
+            if (lock) pthread_mutex_lock(m);
+            else pthread_mutex_unlock(m);
+        }
+    }
+}
+
+// Con las regiones alrededor de j tomadas j no puede moverse (su destino cae
+// en una de ellas): si la posición no cambió mientras se tomaban, lo que se
+// lee es consistente. Las celdas no vuelven a liberarse, así que un jugador
+// sin jugadas queda así hasta el final.
+static bool shard_stuck(shard_t *s, int j) {
+    const game_state_t *gs = s->r->state;
+    for (;;) {
+        uint32_t p = atomic_load(&s->pos[j]);
+        int x = (int)(p & 0xffff), y = (int)(p >> 16);
+        shard_lock_around(s, x, y, true);
+        bool same = atomic_load(&s->pos[j]) == p;
+        bool stuck = true;
+        for (int d = 0; same && stuck && d < 8; d++) {
+            int tx, ty;
+            game_target_from_dir(x, y, d, &tx, &ty);
+            if (tx >= 0 && tx < gs->width && ty >= 0 && ty < gs->height && gs->board[ty * gs->width + tx] > 0) {
+                stuck = false;
+            }
+        }
+        shard_lock_around(s, x, y, false);
+        if (same) return stuck;
+    }
+}
+
+static void shard_finish(shard_t *s, int j) {
+    if (atomic_exchange(&s->finished[j], true)) return;
+    if (atomic_fetch_add(&s->finished_count, 1) + 1 == s->r->player_count) shard_stop(s);
+}
+
+// Tomar (tx, ty) sólo puede dejar sin jugadas al que movió y a los vecinos de esa celda.
+static void shard_recheck(shard_t *s, int i, int tx, int ty) {
+    for (int j = 0; j < s->r->player_count; j++) {
+        if (atomic_load(&s->finished[j])) continue;
+        uint32_t p = atomic_load(&s->pos[j]);
+        int dx = (int)(p & 0xffff) - tx, dy = (int)(p >> 16) - ty;
+        if (j != i && (dx < -1 || dx > 1 || dy < -1 || dy > 1)) continue;
+        if (shard_stuck(s, j)) shard_finish(s, j);
+    }
+}
+
+static void shard_serve(shard_t *s, int ep, int i, uint64_t ready_ns, uint64_t *last_move_ns) {
+    referee_t *r = s->r;
+    game_state_t *gs = r->state;
+    int fd = r->pipes[i][PIPE_READ];
+    unsigned char move;
+    ssize_t got = read(fd, &move, 1);
+    if (got == -1) return;
+    if (got == 0) {
+        if (shard_enter(s) == -1) {
+            shard_fail(s);
+            return;
+        }
+        gs->players[i].blocked = true;
+        shard_leave(s, 0, false);
+        epoll_ctl(ep, EPOLL_CTL_DEL, fd, NULL);
+        close(fd);
+        r->pipes[i][PIPE_READ] = -1;
+        shard_finish(s, i);
+        return;
+    }
+
+    hist_record(&referee_metrics.service_latency[i], metrics_now_ns() - ready_ns);
+    if (last_move_ns[i] != 0) hist_record(&referee_metrics.move_interval[i], ready_ns - last_move_ns[i]);
+    last_move_ns[i] = ready_ns;
+    if (shard_enter(s) == -1) {
+        shard_fail(s);
+        return;
+    }
+    bool valid = false;
+    int tx = -1, ty = -1;
+    if (move <= 7) {
+        game_target_from_dir(gs->players[i].x, gs->players[i].y, move, &tx, &ty);
+        if (tx >= 0 && tx < gs->width && ty >= 0 && ty < gs->height) {
+            pthread_mutex_t *tile = shard_tile(s, tx, ty);
+            pthread_mutex_lock(tile);
+            if (game_is_valid_move_locked(gs, i, (direction_t)move)) {
+                game_apply_move_locked(gs, i, (direction_t)move);
+                atomic_store(&s->pos[i], (uint32_t)tx | (uint32_t)ty << 16);
+                valid = true;
+            }
+            pthread_mutex_unlock(tile);
+        }
+    }
+    if (valid) atomic_store(&s->last_valid_ns, metrics_now_ns());
+    else gs->players[i].invalid_moves++;
+    shard_leave(s, ready_ns, valid);
+    turn_release(r->sync, i);
+    if (valid) shard_recheck(s, i, tx, ty);
+}
+
+static void *shard_worker(void *arg) {
+    shard_worker_t *w = arg;
+    shard_t *s = w->s;
+    referee_t *r = s->r;
+    uint64_t last_move_ns[MAX_PLAYERS] = {0};
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if (ep == -1) {
+        perror("epoll_create1");
+        shard_fail(s);
+        return NULL;
+    }
+    struct epoll_event e = { .events = EPOLLIN, .data.u32 = MAX_PLAYERS };
+    epoll_ctl(ep, EPOLL_CTL_ADD, s->stop_fd, &e);
+    for (int i = w->id; i < r->player_count; i += s->workers) {
+        if (r->pipes[i][PIPE_READ] == -1 || r->state->players[i].blocked) continue;
+        e.data.u32 = (uint32_t)i;
+        if (epoll_ctl(ep, EPOLL_CTL_ADD, r->pipes[i][PIPE_READ], &e) == -1) perror("epoll_ctl pipe");
+    }
+
+    for (;;) {
+        struct epoll_event evs[MAX_PLAYERS + 1];
+        int n = epoll_wait(ep, evs, MAX_PLAYERS + 1, -1);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            shard_fail(s);
+            break;
+        }
+        bool stop = false;
+        for (int k = 0; k < n; k++) {
+            if (evs[k].data.u32 == MAX_PLAYERS) stop = true;
+        }
+        if (stop) break;
+        uint64_t ready_ns = metrics_now_ns();
+        for (int k = 0; k < n; k++) shard_serve(s, ep, (int)evs[k].data.u32, ready_ns, last_move_ns);
+    }
+    close(ep);
+    return NULL;
+}
+
+// Sin vista, pausa, plazos ni volcados: el hilo principal sólo espera el fin
+// (todos terminados o timeout) y atiende los pedidos de métricas (SIGUSR1).
+static int referee_run_sharded(referee_t *r) {
+    game_state_t *gs = r->state;
+    int player_count = r->player_count;
+    shard_t s = { .r = r, .workers = r->workers < player_count ? r->workers : player_count };
+    s.tiles_x = (gs->width + (1 << SHARD_TILE_SHIFT) - 1) >> SHARD_TILE_SHIFT;
+    int tiles_y = (gs->height + (1 << SHARD_TILE_SHIFT) - 1) >> SHARD_TILE_SHIFT;
+    int tile_count = s.tiles_x * tiles_y;
+    s.tiles = malloc((size_t)tile_count * sizeof(*s.tiles));
+    if (!s.tiles) {
+        perror("malloc tiles");
+        return -1;
+    }
+    for (int t = 0; t < tile_count; t++) pthread_mutex_init(&s.tiles[t], NULL);
+    pthread_mutex_init(&s.group_lock, NULL);
+
+    int rc = 0;
+    int ep = -1;
+    int timeout_fd = -1;
+    shard_worker_t workers[MAX_PLAYERS];
+    int started = 0;
+    s.stop_fd = eventfd(0, EFD_CLOEXEC);
+    timeout_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    ep = epoll_create1(EPOLL_CLOEXEC);
+    if (s.stop_fd == -1 || timeout_fd == -1 || ep == -1) {
+        perror("eventfd/timerfd/epoll");
+        rc = -1;
+        goto out;
+    }
+    struct epoll_event e = { .events = EPOLLIN, .data.fd = s.stop_fd };
+    epoll_ctl(ep, EPOLL_CTL_ADD, s.stop_fd, &e);
+    e.data.fd = timeout_fd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, timeout_fd, &e);
+
+    uint64_t timeout_ns = (uint64_t)r->timeout_sec * 1000000000ull;
+    atomic_store(&s.last_valid_ns, metrics_now_ns());
+    arm_timer_ns(timeout_fd, timeout_ns, 0);
+    for (int i = 0; i < player_count; i++) {
+        atomic_store(&s.pos[i], (uint32_t)gs->players[i].x | (uint32_t)gs->players[i].y << 16);
+        if (gs->players[i].blocked || !has_valid_move(gs, i)) shard_finish(&s, i);
+        if (!gs->players[i].blocked) turn_release(r->sync, i);
+    }
+
+    // Las señales (SIGUSR1 de las métricas) quedan para el hilo principal.
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    for (; started < s.workers; started++) {
+        workers[started] = (shard_worker_t){ .s = &s, .id = started };
+        if (pthread_create(&workers[started].tid, NULL, shard_worker, &workers[started]) != 0) {
+            fprintf(stderr, "pthread_create: no se pudo crear el hilo %d del árbitro\n", started);
+            shard_fail(&s);
+            break;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    for (;;) {
+        struct epoll_event ready;
+        int n = epoll_wait(ep, &ready, 1, -1);
+        // Las métricas las escriben los hilos mientras tanto: el volcado es aproximado.
+        if (metrics_take_dump_request()) {
+            metrics_dump_text(stderr, player_count);
+            if (r->metrics_json_path) metrics_dump_json(r->metrics_json_path, player_count);
+        }
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            rc = -1;
+            break;
+        }
+        if (n == 0) continue;
+        if (ready.data.fd == s.stop_fd) break;
+        drain_fd(timeout_fd);
+        uint64_t now = metrics_now_ns();
+        uint64_t last = atomic_load(&s.last_valid_ns);
+        if (now - last >= timeout_ns) break;
+        arm_timer_ns(timeout_fd, last + timeout_ns - now, 0);
+    }
+
+    shard_stop(&s);
+    for (int w = 0; w < started; w++) pthread_join(workers[w].tid, NULL);
+    if (atomic_load(&s.failed)) rc = -1;
+    if (set_game_over(r->sync, gs) == -1) rc = -1;
+
+out:
+    if (ep != -1) close(ep);
+    if (timeout_fd != -1) close(timeout_fd);
+    if (s.stop_fd != -1) close(s.stop_fd);
+    pthread_mutex_destroy(&s.group_lock);
+    for (int t = 0; t < tile_count; t++) pthread_mutex_destroy(&s.tiles[t]);
+    free(s.tiles);
+    return rc;
+}
+
+int referee_run(referee_t *r) {
+    game_state_t *game_state = r->state;
+    game_sync_t *game_sync = r->sync;
+    int (*player_pipes)[2] = r->pipes;
+    int player_count = r->player_count;
+    uint64_t last_move_ns[MAX_PLAYERS] = {0};
+    ready_queue_t rq = {0};
+    int valid_moves = 0;
+    int rc = 0;
+
+    if (r->workers > 1) {
+        if (!r->with_view && r->delay_ms == 0 && r->move_budget_ms == 0 && !r->dump_dir) return referee_run_sharded(r);
+        fprintf(stderr, "árbitro paralelo: sólo sin vista, con -d 0 y sin -b ni -P; se usa un hilo\n");
+    }
+
+    referee_events_t ev;
+    if (events_open(&ev, r, r->view_pid) == -1) {
+        events_close(&ev);
+        return -1;
+    }
+    uint64_t last_valid_ns = metrics_now_ns();
+    arm_timer_ns(ev.timeout_fd, (uint64_t)r->timeout_sec * 1000000000ull, 0);
+
+    for (int i = 0; i < player_count; i++) {
+        if (game_state->players[i].blocked) continue;
+        turn_release(game_sync, i);
+        start_clock(r, &ev, i);
+    }
+
+    while (!game_state->game_over) {
+        bool gated = ev.view_pending || ev.pacing;
+        bool any_pipe = false;
+        for (int i = 0; i < player_count; i++) {
+            if (player_pipes[i][PIPE_READ] != -1 && !game_state->players[i].blocked) any_pipe = true;
+        }
+        if (!any_pipe && !gated) break;
+
+        struct epoll_event evs[MAX_PLAYERS * 2 + 4];
+        trace_event_id_t waiting = ev.view_pending ? TR_VIEW_HANDSHAKE : ev.pacing ? TR_SLEEP : TR_SELECT;
+        trace_begin(waiting);
+        int n = epoll_wait(gated ? ev.ep_gated : ev.ep_open, evs, (int)(sizeof(evs) / sizeof(evs[0])), -1);
+        trace_end(waiting, n);
+        uint64_t ready_ns = metrics_now_ns();
+        if (metrics_take_dump_request()) {
+            metrics_dump_text(stderr, player_count);
+            if (r->metrics_json_path) metrics_dump_json(r->metrics_json_path, player_count);
+        }
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            rc = -1;
+            break;
+        }
+
+        bool ready[MAX_PLAYERS] = {false};
+        bool timed_out = false;
+        for (int k = 0; k < n; k++) {
+            uint64_t tag = evs[k].data.u64;
+            if ((int)(tag >> 32) == EV_PIPE) ready[(uint32_t)tag] = true;
+            else if (handle_control(r, &ev, tag, last_valid_ns)) timed_out = true;
+        }
+        if (timed_out) {
+            set_game_over(game_sync, game_state);
+            break;
+        }
+
+        for (int k = 0; k < player_count; k++) {
+            int i = (rq.rr + k) % player_count;
+            if (ready[i]) rq_push(&rq, i, ready_ns);
+        }
+
+        while (rq.count > 0 && !ev.view_pending && !ev.pacing) {
+            int i = rq_pop(&rq, player_count);
+            if (player_pipes[i][PIPE_READ] == -1) continue;
+
+            unsigned char move;
+            ssize_t bytes_read = read(player_pipes[i][PIPE_READ], &move, 1);
+            if (bytes_read == 0) {
+                if (player_gone(r, i) == -1) break;
+            } else if (bytes_read == 1) {
+                hist_record(&referee_metrics.service_latency[i], metrics_now_ns() - rq.since_ns[i]);
+                ev_rearm_pipe(&ev, player_pipes[i][PIPE_READ], i);
+                if (last_move_ns[i] != 0) hist_record(&referee_metrics.move_interval[i], ready_ns - last_move_ns[i]);
+                last_move_ns[i] = ready_ns;
+                // Una jugada que llega después del plazo se descarta como inválida.
+                bool late = ev.overdue[i];
+                stop_clock(r, &ev, i, ready_ns);
+                trace_begin(TR_VALIDATE);
+                if (lock_master(game_sync) == -1) {
+                    perror("sem_wait master_mutex");
+                    break;
+                }
+                if (lock_state(game_sync) == -1) {
+                    perror("sem_wait state_mutex");
+                    unlock_master(game_sync);
+                    break;
+                }
+
+                trace_instant(TR_MOVE, i * 256 + move);
+                bool valid = false;
+                bool dump = false;
+                position_t pos;
+                if (move > 7 || late) {
+                    game_state->players[i].invalid_moves++;
+                } else if (game_is_valid_move_locked(game_state, i, (direction_t)move)) {
+                    valid_moves++;
+                    dump = should_dump(r, valid_moves) && position_from_state(&pos, game_state, i, move) == 0;
+                    game_apply_move_locked(game_state, i, (direction_t)move);
+                    last_valid_ns = metrics_now_ns();
+                    valid = true;
+                } else {
+                    game_state->players[i].invalid_moves++;
+                }
+
+                unlock_state(game_sync);
+                unlock_master(game_sync);
+                trace_end(TR_VALIDATE, i);
+                hist_record(&referee_metrics.ready_to_apply, metrics_now_ns() - ready_ns);
+                publish_move(valid);
+                if (dump) dump_position(r, &pos, valid_moves);
+
+                if (r->with_view) {
+                    ev.view_pending = true;
+                    ev.view_turn = i;
+                    ev.view_t0 = metrics_now_ns();
+                    sem_post(&game_sync->master_to_view);
+                } else {
+                    release_turn(r, &ev, i);
+                }
+                if (ev.exited[i] && !pipe_has_data(player_pipes[i][PIPE_READ])) player_gone(r, i);
+            }
+        }
+
+        if (lock_state(game_sync) == -1) {
+            if (errno == EINTR) continue;
+            perror("sem_wait state_mutex (any_player check)");
+            break;
+        }
+        bool any_valid = game_any_player_has_valid_move_locked(game_state);
+        bool all_blocked = true;
+        for (int i = 0; i < player_count; i++) {
+            if (!game_state->players[i].blocked) { all_blocked = false; break; }
+        }
+        unlock_state(game_sync);
+
+        if (!any_valid || all_blocked) {
+            set_game_over(game_sync, game_state);
+            break;
+        }
+    }
+
+    // El último cuadro de la vista tiene que terminar antes de soltar el puente.
+    while (ev.view_pending) {
+        struct epoll_event e;
+        int n = epoll_wait(ev.ep_gated, &e, 1, -1);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (n == 1) handle_control(r, &ev, e.data.u64, last_valid_ns);
+    }
+    events_close(&ev);
+    return rc;
+}
+
+void referee_finish(referee_t *r) {
+    game_state_t *game_state = r->state;
+    game_sync_t *game_sync = r->sync;
+    int player_count = r->player_count;
+   
+    if (r->with_view) {
+        sem_post(&game_sync->master_to_view);
+        sem_wait(&game_sync->view_to_master);
+    }
+
+   
+    if (lock_master(game_sync) == -1) {
+        perror("sem_wait master_mutex (final)");
+    } else {
+        if (lock_state(game_sync) == -1) {
+            perror("sem_wait state_mutex (final)");
+            unlock_master(game_sync);
+        } else {
+            game_state->game_over = true;
+            if (telemetry) atomic_store(&telemetry->game_over, 1);
+            if (unlock_state(game_sync) == -1) perror("sem_post state_mutex (final)");
+            if (unlock_master(game_sync) == -1) perror("sem_post master_mutex (final)");
+        }
+    }
+
+    for (int i = 0; i < player_count; i++) {
+        turn_release(game_sync, i);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef REFEREE_H
+#define REFEREE_H
+
+#include "common.h"
+
+// Bucle de arbitraje del master, compartido con el daemon chompd.
+typedef struct {
+    game_state_t *state;
+    game_sync_t *sync;
+    int (*pipes)[2];
+    int player_count;
+    int delay_ms;
+    int timeout_sec;
+    bool with_view;
+    pid_t view_pid;
+    const char *metrics_json_path;
+    // Volcado de posiciones (position.h) antes de aplicar ciertas jugadas válidas:
+    // las de dump_moves (numeradas desde 1) o, si dump_every > 0, una cada dump_every.
+    const char *dump_dir;
+    const int *dump_moves;
+    int dump_move_count;
+    int dump_every;
+    unsigned int dump_tag;
+    // Plazo por jugada desde que se entrega el token, más un banco que absorbe
+    // los excesos. Vencido el plazo la jugada se descarta como inválida, o con
+    // overdue_blocks el jugador queda bloqueado. 0 = sin plazo.
+    int move_budget_ms;
+    int bank_ms;
+    bool overdue_blocks;
+    // > 1: hilos que validan y aplican en paralelo con locks por región del
+    // tablero. Sólo sin vista, pausa, plazos ni volcados; si no, se ignora.
+    int workers;
+} referee_t;
+
+int referee_sync_init(game_sync_t *game_sync);
+void referee_sync_destroy(game_sync_t *game_sync);
+
+// Entrega los tokens iniciales y arbitra hasta que la partida termina.
+int referee_run(referee_t *r);
+
+// Último refresco de la vista, marca game_over y despierta a todos los jugadores.
+void referee_finish(referee_t *r);
+
+#endif
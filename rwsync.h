@@ -0,0 +1,27 @@
+#ifndef RWSYNC_H
+#define RWSYNC_H
+
+#include "common.h"
+
+// Tope de lectores concurrentes que se prueba en bench/bench_rwsync.
+#define MAX_PLAYERS_PROBE 128
+
+// Lado lector del protocolo lectores-escritor sobre game_sync_t. El torniquete
+// master_mutex evita que un flujo continuo de lectores deje sin turno al master.
+static inline void reader_enter(game_sync_t *sync) {
+    sem_wait(&sync->master_mutex);
+    sem_post(&sync->master_mutex);
+
+    sem_wait(&sync->reader_count_mutex);
+    sync->reader_count++;
+    if (sync->reader_count == 1) sem_wait(&sync->state_mutex);
+    sem_post(&sync->reader_count_mutex);
+}
+static inline void reader_exit(game_sync_t *sync) {
+    sem_wait(&sync->reader_count_mutex);
+    sync->reader_count--;
+    if (sync->reader_count == 0) sem_post(&sync->state_mutex);
+    sem_post(&sync->reader_count_mutex);
+}
+
+#endif
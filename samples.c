@@ -0,0 +1,217 @@
+#include "samples.h"
+#include "lz.h"
+
+enum { COL_GAME, COL_PLY, COL_TO_MOVE, COL_MOVE, COL_BOARD, COL_X, COL_Y, COL_SCORE, COL_BLOCKED, COL_FINAL };
+
+typedef struct {
+    char magic[4];
+    uint32_t count;
+    uint32_t raw_len[SAMPLES_COLUMNS];
+    uint32_t stored_len[SAMPLES_COLUMNS];
+} block_header_t;
+
+uint32_t samples_max_block(int width, int height, int player_count) {
+    size_t widest = (size_t)width * height;
+    if ((size_t)4 * player_count > widest) widest = (size_t)4 * player_count;
+    return (uint32_t)(UINT32_MAX / widest);
+}
+
+int samples_block_init(samples_block_t *b, int width, int height, int player_count, uint32_t capacity) {
+    memset(b, 0, sizeof(*b));
+    if (capacity > samples_max_block(width, height, player_count)) {
+        errno = EINVAL;
+        return -1;
+    }
+    b->width = width;
+    b->height = height;
+    b->player_count = player_count;
+    b->capacity = capacity;
+    size_t pc = (size_t)player_count;
+    size_t widths[SAMPLES_COLUMNS] = {
+        [COL_GAME] = 4, [COL_PLY] = 4, [COL_TO_MOVE] = 1, [COL_MOVE] = 1, [COL_BOARD] = (size_t)width * height,
+        [COL_X] = 2 * pc, [COL_Y] = 2 * pc, [COL_SCORE] = 4 * pc, [COL_BLOCKED] = pc, [COL_FINAL] = 4 * pc
+    };
+    size_t total = 0;
+    for (int c = 0; c < SAMPLES_COLUMNS; c++) {
+        b->col_width[c] = widths[c];
+        b->col[c] = malloc(widths[c] * capacity);
+        if (!b->col[c]) {
+            samples_block_free(b);
+            return -1;
+        }
+        total += lz_bound(widths[c] * capacity);
+    }
+    b->packed = malloc(total);
+    b->packed_cap = total;
+    if (!b->packed) {
+        samples_block_free(b);
+        return -1;
+    }
+    return 0;
+}
+
+void samples_block_free(samples_block_t *b) {
+    for (int c = 0; c < SAMPLES_COLUMNS; c++) {
+        free(b->col[c]);
+        b->col[c] = NULL;
+    }
+    free(b->packed);
+    b->packed = NULL;
+}
+
+bool samples_block_push(samples_block_t *b, const samples_row_t *r) {
+    if (b->count == b->capacity) return false;
+    uint32_t i = b->count++;
+    int pc = b->player_count;
+    memcpy(b->col[COL_GAME] + 4 * (size_t)i, &r->game, 4);
+    memcpy(b->col[COL_PLY] + 4 * (size_t)i, &r->ply, 4);
+    b->col[COL_TO_MOVE][i] = r->to_move;
+    b->col[COL_MOVE][i] = (uint8_t)r->move;
+    memcpy(b->col[COL_BOARD] + b->col_width[COL_BOARD] * i, r->board, b->col_width[COL_BOARD]);
+    uint16_t *xs = (uint16_t *)(void *)(b->col[COL_X] + b->col_width[COL_X] * i);
+    uint16_t *ys = (uint16_t *)(void *)(b->col[COL_Y] + b->col_width[COL_Y] * i);
+    uint32_t *score = (uint32_t *)(void *)(b->col[COL_SCORE] + b->col_width[COL_SCORE] * i);
+    uint8_t *blocked = b->col[COL_BLOCKED] + b->col_width[COL_BLOCKED] * i;
+    uint32_t *final = (uint32_t *)(void *)(b->col[COL_FINAL] + b->col_width[COL_FINAL] * i);
+    for (int p = 0; p < pc; p++) {
+        xs[p] = (uint16_t)r->players[p].x;
+        ys[p] = (uint16_t)r->players[p].y;
+        score[p] = r->players[p].score;
+        blocked[p] = r->players[p].blocked;
+        final[p] = r->final_score[p];
+    }
+    return true;
+}
+
+void samples_block_get(const samples_block_t *b, uint32_t i, samples_row_t *r) {
+    int pc = b->player_count;
+    memcpy(&r->game, b->col[COL_GAME] + 4 * (size_t)i, 4);
+    memcpy(&r->ply, b->col[COL_PLY] + 4 * (size_t)i, 4);
+    r->to_move = b->col[COL_TO_MOVE][i];
+    r->move = (int8_t)b->col[COL_MOVE][i];
+    memcpy(r->board, b->col[COL_BOARD] + b->col_width[COL_BOARD] * i, b->col_width[COL_BOARD]);
+    const uint16_t *xs = (const uint16_t *)(const void *)(b->col[COL_X] + b->col_width[COL_X] * i);
+    const uint16_t *ys = (const uint16_t *)(const void *)(b->col[COL_Y] + b->col_width[COL_Y] * i);
+    const uint32_t *score = (const uint32_t *)(const void *)(b->col[COL_SCORE] + b->col_width[COL_SCORE] * i);
+    const uint8_t *blocked = b->col[COL_BLOCKED] + b->col_width[COL_BLOCKED] * i;
+    const uint32_t *final = (const uint32_t *)(const void *)(b->col[COL_FINAL] + b->col_width[COL_FINAL] * i);
+    for (int p = 0; p < pc; p++) {
+        r->players[p].x = xs[p];
+        r->players[p].y = ys[p];
+        r->players[p].score = score[p];
+        r->players[p].blocked = blocked[p] != 0;
+        r->final_score[p] = final[p];
+    }
+}
+
+int samples_writer_open(samples_writer_t *w, const char *path, int width, int height, int player_count,
+                        uint32_t block_samples, bool compress) {
+    memset(w, 0, sizeof(*w));
+    w->f = fopen(path, "wb");
+    if (!w->f) return -1;
+    // Los bloques llegan de a varios cientos de KiB: un buffer grande evita
+    // partir cada uno en muchas escrituras chicas.
+    setvbuf(w->f, NULL, _IOFBF, 1 << 20);
+    samples_header_t hdr = {
+        .version = SAMPLES_VERSION, .width = (uint16_t)width, .height = (uint16_t)height,
+        .player_count = (uint8_t)player_count, .flags = compress ? SAMPLES_FLAG_LZ : 0, .block_samples = block_samples
+    };
+    memcpy(hdr.magic, SAMPLES_MAGIC, 4);
+    if (fwrite(&hdr, sizeof(hdr), 1, w->f) != 1) {
+        fclose(w->f);
+        return -1;
+    }
+    w->compress = compress;
+    pthread_mutex_init(&w->lock, NULL);
+    return 0;
+}
+
+int samples_write_block(samples_writer_t *w, samples_block_t *b) {
+    if (b->count == 0) return 0;
+    block_header_t bh = { .count = b->count };
+    memcpy(bh.magic, SAMPLES_BLOCK_MAGIC, 4);
+    size_t off = 0;
+    for (int c = 0; c < SAMPLES_COLUMNS; c++) {
+        size_t raw = b->col_width[c] * b->count;
+        size_t stored = w->compress ? lz_compress(b->col[c], raw, b->packed + off, b->packed_cap - off) : 0;
+        // Si no achica se guarda crudo.
+        if (stored == 0 || stored >= raw) {
+            memcpy(b->packed + off, b->col[c], raw);
+            stored = raw;
+        }
+        bh.raw_len[c] = (uint32_t)raw;
+        bh.stored_len[c] = (uint32_t)stored;
+        off += stored;
+    }
+
+    pthread_mutex_lock(&w->lock);
+    int rc = 0;
+    if (fwrite(&bh, sizeof(bh), 1, w->f) != 1 || fwrite(b->packed, 1, off, w->f) != off) {
+        rc = -1;
+    } else {
+        w->samples += b->count;
+        w->blocks++;
+        for (int c = 0; c < SAMPLES_COLUMNS; c++) w->raw_bytes += bh.raw_len[c];
+        w->stored_bytes += off;
+    }
+    pthread_mutex_unlock(&w->lock);
+    b->count = 0;
+    return rc;
+}
+
+int samples_writer_close(samples_writer_t *w) {
+    pthread_mutex_destroy(&w->lock);
+    if (ferror(w->f)) {
+        fclose(w->f);
+        return -1;
+    }
+    return fclose(w->f);
+}
+
+int samples_reader_open(samples_reader_t *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    r->f = fopen(path, "rb");
+    if (!r->f) return -1;
+    if (fread(&r->hdr, sizeof(r->hdr), 1, r->f) != 1 || memcmp(r->hdr.magic, SAMPLES_MAGIC, 4) != 0 ||
+        r->hdr.version != SAMPLES_VERSION || r->hdr.player_count < 1 || r->hdr.player_count > MAX_PLAYERS ||
+        r->hdr.width == 0 || r->hdr.height == 0 || r->hdr.block_samples == 0 ||
+        r->hdr.block_samples > samples_max_block(r->hdr.width, r->hdr.height, r->hdr.player_count)) {
+        fclose(r->f);
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int samples_read_block(samples_reader_t *r, samples_block_t *b) {
+    block_header_t bh;
+    size_t got = fread(&bh, 1, sizeof(bh), r->f);
+    if (got == 0 && feof(r->f)) return 0;
+    if (got != sizeof(bh) || memcmp(bh.magic, SAMPLES_BLOCK_MAGIC, 4) != 0 || bh.count > b->capacity) return -1;
+    for (int c = 0; c < SAMPLES_COLUMNS; c++) {
+        size_t raw = b->col_width[c] * bh.count;
+        if (bh.raw_len[c] != raw || bh.stored_len[c] > raw) return -1;
+        if (bh.stored_len[c] == raw) {
+            if (fread(b->col[c], 1, raw, r->f) != raw) return -1;
+            continue;
+        }
+        if (bh.stored_len[c] > r->scratch_size) {
+            uint8_t *p = realloc(r->scratch, bh.stored_len[c]);
+            if (!p) return -1;
+            r->scratch = p;
+            r->scratch_size = bh.stored_len[c];
+        }
+        if (fread(r->scratch, 1, bh.stored_len[c], r->f) != bh.stored_len[c] ||
+            lz_decompress(r->scratch, bh.stored_len[c], b->col[c], raw) == -1) {
+            return -1;
+        }
+    }
+    b->count = bh.count;
+    return 1;
+}
+
+void samples_reader_close(samples_reader_t *r) {
+    fclose(r->f);
+    free(r->scratch);
+    r->scratch = NULL;
+}
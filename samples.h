@@ -0,0 +1,104 @@
+#ifndef SAMPLES_H
+#define SAMPLES_H
+
+#include "common.h"
+#include "sim.h"
+#include <stdio.h>
+#include <pthread.h>
+
+// Muestras de self-play (posición, jugada, resultado) en formato columnar:
+//
+//   cabecera: "CSMP", versión, ancho, alto, jugadores, flags, muestras por bloque
+//   bloques:  "SBLK", cantidad, y por columna (largo crudo, largo guardado);
+//             después las columnas una tras otra. Si el largo guardado es
+//             menor que el crudo la columna va comprimida con lz.c.
+//
+// Columnas: partida (u32), jugada número (u32), quién mueve (u8), jugada (i8),
+// tablero (i8 por celda, igual que en la shm), x e y (u16 por jugador),
+// puntaje (u32 por jugador), bloqueado (u8 por jugador) y puntaje final (u32
+// por jugador). Cada columna de un bloque guarda los valores de todas sus
+// muestras seguidos, así los tableros consecutivos de una partida quedan a
+// distancia fija y el compresor los reduce a casi sólo la celda que cambió.
+#define SAMPLES_MAGIC "CSMP"
+#define SAMPLES_BLOCK_MAGIC "SBLK"
+#define SAMPLES_VERSION 2
+#define SAMPLES_COLUMNS 10
+#define SAMPLES_FLAG_LZ 1u
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint16_t width;
+    uint16_t height;
+    uint8_t player_count;
+    uint8_t flags;
+    uint16_t reserved;
+    uint32_t block_samples;
+} samples_header_t;
+
+typedef struct {
+    uint32_t game;
+    uint32_t ply;
+    uint8_t to_move;
+    int8_t move;
+    int8_t *board;                 // width * height
+    sim_player_t players[MAX_PLAYERS];
+    unsigned int final_score[MAX_PLAYERS];
+} samples_row_t;
+
+// Un bloque en memoria, en columnas; el escritor llena uno por hilo.
+typedef struct {
+    int width;
+    int height;
+    int player_count;
+    uint32_t capacity;
+    uint32_t count;
+    uint8_t *col[SAMPLES_COLUMNS];
+    size_t col_width[SAMPLES_COLUMNS];   // bytes por muestra
+    uint8_t *packed;                     // salida del compresor, del hilo dueño
+    size_t packed_cap;
+} samples_block_t;
+
+// Los largos de cada columna se guardan en 32 bits: ninguna puede pasar de
+// UINT32_MAX bytes por bloque. Devuelve cuántas muestras entran como máximo.
+uint32_t samples_max_block(int width, int height, int player_count);
+// -1 sin memoria o, con errno = EINVAL, si capacity pasa de samples_max_block.
+int samples_block_init(samples_block_t *b, int width, int height, int player_count, uint32_t capacity);
+void samples_block_free(samples_block_t *b);
+// false si el bloque está lleno.
+bool samples_block_push(samples_block_t *b, const samples_row_t *r);
+// Lee la muestra i del bloque (r->board tiene que tener width * height bytes).
+void samples_block_get(const samples_block_t *b, uint32_t i, samples_row_t *r);
+
+// Escritor compartido por varios hilos: cada uno llena su bloque y lo
+// vuelca entero con samples_write_block. La compresión corre en el hilo que
+// llama; sólo la escritura al archivo va bajo el mutex.
+typedef struct {
+    FILE *f;
+    pthread_mutex_t lock;
+    bool compress;
+    uint64_t samples;
+    uint64_t blocks;
+    uint64_t raw_bytes;
+    uint64_t stored_bytes;
+} samples_writer_t;
+
+int samples_writer_open(samples_writer_t *w, const char *path, int width, int height, int player_count,
+                        uint32_t block_samples, bool compress);
+int samples_write_block(samples_writer_t *w, samples_block_t *b);
+int samples_writer_close(samples_writer_t *w);
+
+typedef struct {
+    FILE *f;
+    samples_header_t hdr;
+    uint8_t *scratch;
+    size_t scratch_size;
+} samples_reader_t;
+
+int samples_reader_open(samples_reader_t *r, const char *path);
+// b tiene que estar inicializado con las dimensiones de r->hdr. Devuelve 1
+// con un bloque leído, 0 al final del archivo y -1 si está corrupto.
+int samples_read_block(samples_reader_t *r, samples_block_t *b);
+void samples_reader_close(samples_reader_t *r);
+
+#endif
@@ -0,0 +1,334 @@
+#include "common.h"
+#include "game.h"
+#include "strategy.h"
+#include "samples.h"
+#include <getopt.h>
+
+// Generador de muestras de self-play: varios hilos juegan partidas completas
+// con game_play_local (las reglas del modo en proceso) y guardan cada posición (antes de mover), la
+// jugada elegida y el puntaje final de todos en el formato de samples.h.
+// Con -S 0 las jugadas salen de la política rápida de los playouts; con
+// -S > 0 de la estrategia completa con ese presupuesto.
+
+typedef struct {
+    int width;
+    int height;
+    int players;
+    int games;
+    int threads;
+    int sims;
+    int seed;
+    double epsilon;
+    uint32_t block_samples;
+    bool compress;
+    const char *out;
+} selfplay_opts_t;
+
+typedef struct {
+    const selfplay_opts_t *o;
+    samples_writer_t *writer;
+    int first_game;
+    int game_count;
+    unsigned long long samples;
+    int failed;
+} selfplay_worker_t;
+
+static float frand(unsigned int *rng) {
+    return (float)(sim_rng_next(rng) & 0xFFFFFF) / (float)0x1000000;
+}
+
+static int pick_move(const selfplay_opts_t *o, game_state_t *gs, strategy_t *seat, sim_player_t *sp, int i, unsigned int *rng) {
+    if (o->epsilon > 0.0 && frand(rng) < o->epsilon) {
+        int dirs[8], n = 0;
+        for (int d = 0; d < 8; d++) {
+            if (game_is_valid_move_locked(gs, i, (direction_t)d)) dirs[n++] = d;
+        }
+        return n ? dirs[sim_rng_next(rng) % n] : -1;
+    }
+    if (!seat) return sim_pick_policy_move(gs->board, o->width, o->height, sp, o->players, i, rng, NULL);
+    strategy_budget_t budget = { .max_sims = o->sims };
+    strategy_state_t st = { .width = o->width, .height = o->height, .player_count = o->players, .my_index = i,
+                            .board = gs->board, .players = sp };
+    return strategy_decide(seat, &st, &budget);
+}
+
+// Una partida no puede tener más jugadas que celdas. Sólo se guarda la
+// secuencia (quién, adónde y quiénes estaban bloqueados); al terminar se
+// rejuega desde el tablero inicial, ya con el resultado, y cada posición pasa
+// al bloque.
+typedef struct {
+    const selfplay_opts_t *o;
+    game_state_t *gs;
+    strategy_t **seats;
+    unsigned int rng;
+    sim_player_t sp[MAX_PLAYERS];
+    sim_player_t first[MAX_PLAYERS];
+    int *start;
+    uint8_t *who;
+    int8_t *moves;
+    uint16_t *blocked;
+    int n;
+} selfplay_game_t;
+
+static int selfplay_decide(void *arg, const game_state_t *gs, int i) {
+    selfplay_game_t *g = arg;
+    strategy_players_from_state(g->sp, gs->players, g->o->players);
+    return pick_move(g->o, g->gs, g->seats[i], g->sp, i, &g->rng);
+}
+
+static void selfplay_on_start(void *arg, const game_state_t *gs) {
+    selfplay_game_t *g = arg;
+    memcpy(g->start, gs->board, sizeof(int) * (size_t)gs->width * gs->height);
+    strategy_players_from_state(g->first, gs->players, g->o->players);
+    g->n = 0;
+}
+
+static int selfplay_on_move(void *arg, const game_state_t *gs, int i, int move) {
+    selfplay_game_t *g = arg;
+    if (g->n == gs->width * gs->height) return 0;
+    uint16_t mask = 0;
+    for (int p = 0; p < g->o->players; p++) mask |= (uint16_t)(gs->players[p].blocked << p);
+    g->who[g->n] = (uint8_t)i;
+    g->moves[g->n] = (int8_t)move;
+    g->blocked[g->n] = mask;
+    g->n++;
+    return 0;
+}
+
+static void *selfplay_worker(void *arg) {
+    selfplay_worker_t *w = arg;
+    const selfplay_opts_t *o = w->o;
+    int width = o->width, height = o->height, pc = o->players, cells = width * height;
+
+    game_state_t *gs = malloc(game_state_size(width, height));
+    int8_t *board = malloc((size_t)cells);
+    strategy_t *seats[MAX_PLAYERS] = {0};
+    selfplay_game_t sg = {
+        .o = o, .gs = gs, .seats = seats,
+        .rng = (unsigned int)(o->seed * 2654435761u + (unsigned int)w->first_game) | 1u,
+        .start = malloc(sizeof(int) * (size_t)cells),
+        .who = malloc((size_t)cells),
+        .moves = malloc((size_t)cells),
+        .blocked = malloc(sizeof(uint16_t) * (size_t)cells)
+    };
+    game_local_hooks_t hooks = { .decide = selfplay_decide, .on_start = selfplay_on_start, .on_move = selfplay_on_move,
+                                 .ctx = &sg };
+    samples_block_t block;
+    bool have_block = false;
+    if (!gs || !sg.start || !sg.who || !sg.moves || !sg.blocked || !board) goto fail;
+    if (samples_block_init(&block, width, height, pc, o->block_samples) == -1) goto fail;
+    have_block = true;
+    if (o->sims > 0) {
+        for (int i = 0; i < pc; i++) {
+            seats[i] = strategy_create(width, height, pc, (unsigned int)(o->seed * 31 + w->first_game * MAX_PLAYERS + i + 1));
+            if (!seats[i]) goto fail;
+        }
+    }
+
+    sim_player_t sp[MAX_PLAYERS];
+    for (int g = 0; g < w->game_count; g++) {
+        unsigned int game = (unsigned int)(w->first_game + g);
+        game_play_local(gs, width, height, pc, (unsigned int)o->seed + game, &hooks);
+
+        samples_row_t row = { .game = game, .board = board };
+        for (int p = 0; p < pc; p++) row.final_score[p] = gs->players[p].score;
+        memcpy(sp, sg.first, sizeof(sim_player_t) * pc);
+        for (int k = 0; k < sg.n; k++) {
+            row.ply = (uint32_t)k;
+            row.to_move = sg.who[k];
+            row.move = sg.moves[k];
+            for (int c = 0; c < cells; c++) board[c] = (int8_t)sg.start[c];
+            for (int p = 0; p < pc; p++) {
+                row.players[p] = sp[p];
+                row.players[p].blocked = sg.blocked[k] >> p & 1;
+            }
+            if (!samples_block_push(&block, &row)) {
+                if (samples_write_block(w->writer, &block) == -1) goto fail;
+                samples_block_push(&block, &row);
+            }
+            sim_apply_move(sg.start, width, height, sp, sg.who[k], sg.moves[k]);
+        }
+        w->samples += (unsigned long long)sg.n;
+    }
+    if (samples_write_block(w->writer, &block) == -1) goto fail;
+    goto out;
+
+fail:
+    w->failed = 1;
+out:
+    for (int i = 0; i < pc; i++) strategy_destroy(seats[i]);
+    if (have_block) samples_block_free(&block);
+    free(board);
+    free(sg.blocked);
+    free(sg.moves);
+    free(sg.who);
+    free(sg.start);
+    free(gs);
+    return NULL;
+}
+
+static double elapsed(const struct timespec *t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static int generate(const selfplay_opts_t *o) {
+    samples_writer_t writer;
+    if (samples_writer_open(&writer, o->out, o->width, o->height, o->players, o->block_samples, o->compress) == -1) {
+        perror(o->out);
+        return -1;
+    }
+    int threads = o->threads;
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+    if (threads > o->games) threads = o->games;
+
+    selfplay_worker_t *workers = calloc(threads, sizeof(selfplay_worker_t));
+    pthread_t *tids = calloc(threads, sizeof(pthread_t));
+    if (!workers || !tids) {
+        perror("calloc");
+        free(workers);
+        free(tids);
+        samples_writer_close(&writer);
+        return -1;
+    }
+
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int next_game = 0;
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t].o = o;
+        workers[t].writer = &writer;
+        workers[t].first_game = next_game;
+        workers[t].game_count = o->games / threads + (t < o->games % threads ? 1 : 0);
+        next_game += workers[t].game_count;
+        if (pthread_create(&tids[t], NULL, selfplay_worker, &workers[t]) != 0) {
+            perror("pthread_create");
+            break;
+        }
+        started++;
+    }
+    int failed = started < threads;
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+        failed |= workers[t].failed;
+    }
+    double secs = elapsed(&t0);
+    if (samples_writer_close(&writer) == -1) {
+        perror(o->out);
+        failed = 1;
+    }
+
+    printf("%llu muestras de %d partidas %dx%d en %.3f s (%.0f muestras/min, %d hilos)\n",
+           (unsigned long long)writer.samples, o->games, o->width, o->height, secs,
+           secs > 0 ? writer.samples * 60.0 / secs : 0.0, started);
+    printf("%llu bloques, %.1f MiB crudos -> %.1f MiB en %s (%.1fx)\n", (unsigned long long)writer.blocks,
+           writer.raw_bytes / 1048576.0, writer.stored_bytes / 1048576.0, o->out,
+           writer.stored_bytes ? (double)writer.raw_bytes / (double)writer.stored_bytes : 0.0);
+    free(workers);
+    free(tids);
+    return failed ? -1 : 0;
+}
+
+// Recorre el archivo entero, decodificando cada bloque, y resume su contenido.
+static int report(const char *path) {
+    samples_reader_t r;
+    if (samples_reader_open(&r, path) == -1) {
+        perror(path);
+        return -1;
+    }
+    const samples_header_t *h = &r.hdr;
+    samples_block_t b;
+    int8_t *board = malloc((size_t)h->width * h->height);
+    if (!board || samples_block_init(&b, h->width, h->height, h->player_count, h->block_samples) == -1) {
+        perror("malloc");
+        free(board);
+        samples_reader_close(&r);
+        return -1;
+    }
+
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    unsigned long long samples = 0, blocks = 0, games = 0, margin_sum = 0;
+    samples_row_t row = { .board = board };
+    int rc;
+    while ((rc = samples_read_block(&r, &b)) == 1) {
+        blocks++;
+        for (uint32_t i = 0; i < b.count; i++) {
+            samples_block_get(&b, i, &row);
+            // Los bloques de distintos hilos se intercalan: cada partida se cuenta por su primera jugada.
+            if (row.ply != 0) continue;
+            games++;
+            unsigned int best = 0, second = 0;
+            for (int p = 0; p < h->player_count; p++) {
+                unsigned int s = row.final_score[p];
+                if (s > best) {
+                    second = best;
+                    best = s;
+                } else if (s > second) {
+                    second = s;
+                }
+            }
+            margin_sum += best - second;
+        }
+        samples += b.count;
+    }
+    double secs = elapsed(&t0);
+    if (rc == -1) fprintf(stderr, "%s: bloque %llu corrupto\n", path, blocks);
+    long size = ftell(r.f);
+    printf("%s: %dx%d, %d jugadores, %s, %u muestras por bloque\n", path, h->width, h->height, h->player_count,
+           h->flags & SAMPLES_FLAG_LZ ? "comprimido" : "sin comprimir", h->block_samples);
+    printf("%llu muestras, %llu partidas, %llu bloques, %ld bytes (%.1f bytes/muestra)\n", samples, games, blocks,
+           size, samples ? (double)size / (double)samples : 0.0);
+    printf("margen medio del ganador: %.2f; lectura a %.0f muestras/s\n",
+           games ? (double)margin_sum / (double)games : 0.0, secs > 0 ? samples / secs : 0.0);
+    samples_block_free(&b);
+    free(board);
+    samples_reader_close(&r);
+    return rc == -1 ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    selfplay_opts_t o = { .width = 10, .height = 10, .players = 2, .games = 1000, .threads = 0, .sims = 0, .seed = 1,
+                          .epsilon = 0.0, .block_samples = 4096, .compress = true, .out = "samples.bin" };
+    const char *report_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:g:j:S:s:x:B:zo:r:")) != -1) {
+        switch (opt) {
+            case 'w': o.width = atoi(optarg); break;
+            case 'h': o.height = atoi(optarg); break;
+            case 'n': o.players = atoi(optarg); break;
+            case 'g': o.games = atoi(optarg); break;
+            case 'j': o.threads = atoi(optarg); break;
+            case 'S': o.sims = atoi(optarg); break;
+            case 's': o.seed = atoi(optarg); break;
+            case 'x': o.epsilon = atof(optarg); break;
+            case 'B': o.block_samples = (uint32_t)atoi(optarg); break;
+            case 'z': o.compress = false; break;
+            case 'o': o.out = optarg; break;
+            case 'r': report_path = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-w ancho] [-h alto] [-n jugadores] [-g partidas] [-j hilos] [-S sims] [-s semilla] [-x epsilon] [-B muestras_bloque] [-z] [-o salida]\n"
+                                "       %s -r archivo\n", argv[0], argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (report_path) return report(report_path) == -1 ? EXIT_FAILURE : EXIT_SUCCESS;
+    if (o.width <= 0 || o.height <= 0 || o.width > UINT16_MAX || o.height > UINT16_MAX || o.players < 1 ||
+        o.players > MAX_PLAYERS || o.games <= 0 || o.sims < 0 || o.block_samples == 0) {
+        fprintf(stderr, "Parámetros inválidos\n");
+        return EXIT_FAILURE;
+    }
+    uint32_t max_block = samples_max_block(o.width, o.height, o.players);
+    if (o.block_samples > max_block) {
+        fprintf(stderr, "-B %u no entra en un bloque de %dx%d (máximo %u muestras)\n", o.block_samples, o.width, o.height,
+                max_block);
+        return EXIT_FAILURE;
+    }
+    // Las muestras salen de la búsqueda, sin libro ni red cargados por entorno.
+    unsetenv("CHOMP_BOOK");
+    unsetenv("CHOMP_EVAL");
+    return generate(&o) == -1 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -80,15 +80,15 @@ shm_manager_t *shm_manager_create(const char *name, size_t data_size, mode_t mod
     return r;
 }
 
-shm_manager_t *shm_manager_open(const char *name, size_t data_size, int with_front_sem)
+static shm_manager_t *shm_manager_open_mode(const char *name, size_t data_size, int with_front_sem, int force_ro)
 {
     if (!name) {
         errno = EINVAL;
         return NULL;
     }
 
-    int fd = shm_open(name, O_RDWR, 0);
-    int read_only = 0;
+    int fd = shm_open(name, force_ro ? O_RDONLY : O_RDWR, 0);
+    int read_only = force_ro ? 1 : 0;
 
     if (fd == -1) {
         if (errno == EACCES && !with_front_sem) {
@@ -161,6 +161,16 @@ shm_manager_t *shm_manager_open(const char *name, size_t data_size, int with_fro
     return r;
 }
 
+shm_manager_t *shm_manager_open(const char *name, size_t data_size, int with_front_sem)
+{
+    return shm_manager_open_mode(name, data_size, with_front_sem, 0);
+}
+
+shm_manager_t *shm_manager_open_readonly(const char *name, size_t data_size)
+{
+    return shm_manager_open_mode(name, data_size, 0, 1);
+}
+
 int shm_manager_close(shm_manager_t *r)
 {
     if (!r) {
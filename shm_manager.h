@@ -16,6 +16,8 @@ shm_manager_t *shm_manager_create(const char *name, size_t data_size, mode_t mod
 
 shm_manager_t *shm_manager_open(const char *name, size_t data_size, int with_front_sem);
 
+shm_manager_t *shm_manager_open_readonly(const char *name, size_t data_size);
+
 int shm_manager_close(shm_manager_t *mgr);
 
 int shm_manager_destroy(shm_manager_t *mgr);
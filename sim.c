@@ -0,0 +1,249 @@
+#include "sim.h"
+#include "game.h"
+#include <float.h>
+#include <pthread.h>
+#include <strings.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIM_X86 1
+#include <immintrin.h>
+#endif
+
+const sim_policy_t sim_policy_default = SIM_POLICY_DEFAULT;
+
+// Desplazamientos de las 8 direcciones (mismo orden que direction_t).
+static const int dir_dx[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int dir_dy[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+// Variante escalar: siempre disponible y la única fuera de x86.
+static inline int libs_at_scalar(const int *b, int w, int h, int x, int y) {
+    if (x > 0 && x < w - 1 && y > 0 && y < h - 1) {
+        int idx = y * w + x;
+        return (b[idx - w - 1] > 0) + (b[idx - w] > 0) + (b[idx - w + 1] > 0) + (b[idx - 1] > 0) +
+               (b[idx + 1] > 0) + (b[idx + w - 1] > 0) + (b[idx + w] > 0) + (b[idx + w + 1] > 0);
+    }
+    int c = 0;
+    for (int k = 0; k < 8; k++) {
+        int nx = x + dir_dx[k];
+        int ny = y + dir_dy[k];
+        if (nx >= 0 && nx < w && ny >= 0 && ny < h && b[ny * w + nx] > 0) c++;
+    }
+    return c;
+}
+
+// Libertades del destino de cada dirección desde (x, y); basura si el destino está afuera.
+static inline void target_libs_scalar(const int *b, int w, int h, int x, int y, int *libs) {
+    for (int d = 0; d < 8; d++) {
+        int tx = x + dir_dx[d];
+        int ty = y + dir_dy[d];
+        libs[d] = (tx >= 0 && tx < w && ty >= 0 && ty < h) ? libs_at_scalar(b, w, h, tx, ty) : 0;
+    }
+}
+
+#define KERNEL(name) name##_scalar
+#define KERNEL_NAME "scalar"
+#define TARGET_LIBS target_libs_scalar
+#include "sim_kernels.inc"
+#undef KERNEL
+#undef KERNEL_NAME
+#undef TARGET_LIBS
+
+#ifdef SIM_X86
+// SSE4.2: una máscara de 25 bits con las celdas libres de la ventana 5x5
+// alrededor del jugador (dos cargas de 4 enteros por fila) y un popcnt por
+// destino contra el anillo 3x3 sin centro.
+#pragma GCC push_options
+#pragma GCC target("sse4.2,popcnt")
+static inline void target_libs_sse42(const int *b, int w, int h, int x, int y, int *libs) {
+    if (x < 2 || x >= w - 2 || y < 2 || y >= h - 2) {
+        target_libs_scalar(b, w, h, x, y, libs);
+        return;
+    }
+    __m128i z = _mm_setzero_si128();
+    unsigned int m = 0;
+    for (int r = 0; r < 5; r++) {
+        const int *row = b + (y - 2 + r) * w + x - 2;
+        int lo = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i *)row), z)));
+        int hi = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i *)(row + 1)), z)));
+        m |= (unsigned int)(lo | hi << 1) << (5 * r);
+    }
+    for (int d = 0; d < 8; d++) {
+        libs[d] = __builtin_popcount(m & (0x1CA7u << (5 * (1 + dir_dy[d]) + 1 + dir_dx[d])));
+    }
+}
+
+#define KERNEL(name) name##_sse42
+#define KERNEL_NAME "sse4.2"
+#define TARGET_LIBS target_libs_sse42
+#include "sim_kernels.inc"
+#undef KERNEL
+#undef KERNEL_NAME
+#undef TARGET_LIBS
+#pragma GCC pop_options
+
+// AVX2: un carril por dirección; 8 gathers (uno por vecino) cuentan las
+// libertades de los 8 destinos a la vez. En los bordes el gather va enmascarado.
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+static inline void target_libs_avx2(const int *b, int w, int h, int x, int y, int *libs) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i dx = _mm256_loadu_si256((const __m256i *)dir_dx);
+    __m256i dy = _mm256_loadu_si256((const __m256i *)dir_dy);
+    __m256i acc = zero;
+    if (x >= 2 && x < w - 2 && y >= 2 && y < h - 2) {
+        __m256i t = _mm256_add_epi32(_mm256_set1_epi32(y * w + x), _mm256_add_epi32(_mm256_mullo_epi32(dy, _mm256_set1_epi32(w)), dx));
+        for (int k = 0; k < 8; k++) {
+            __m256i idx = _mm256_add_epi32(t, _mm256_set1_epi32(dir_dy[k] * w + dir_dx[k]));
+            __m256i v = _mm256_i32gather_epi32(b, idx, 4);
+            acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(v, zero));
+        }
+    } else {
+        __m256i vw = _mm256_set1_epi32(w);
+        __m256i vh = _mm256_set1_epi32(h);
+        __m256i neg = _mm256_set1_epi32(-1);
+        __m256i tx = _mm256_add_epi32(_mm256_set1_epi32(x), dx);
+        __m256i ty = _mm256_add_epi32(_mm256_set1_epi32(y), dy);
+        for (int k = 0; k < 8; k++) {
+            __m256i nx = _mm256_add_epi32(tx, _mm256_set1_epi32(dir_dx[k]));
+            __m256i ny = _mm256_add_epi32(ty, _mm256_set1_epi32(dir_dy[k]));
+            __m256i in = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(nx, neg), _mm256_cmpgt_epi32(vw, nx)),
+                                          _mm256_and_si256(_mm256_cmpgt_epi32(ny, neg), _mm256_cmpgt_epi32(vh, ny)));
+            __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(ny, vw), nx);
+            __m256i v = _mm256_mask_i32gather_epi32(zero, b, idx, in, 4);
+            acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(v, zero));
+        }
+    }
+    _mm256_storeu_si256((__m256i *)libs, acc);
+}
+
+#define KERNEL(name) name##_avx2
+#define KERNEL_NAME "avx2"
+#define TARGET_LIBS target_libs_avx2
+#include "sim_kernels.inc"
+#undef KERNEL
+#undef KERNEL_NAME
+#undef TARGET_LIBS
+#pragma GCC pop_options
+
+// AVX-512: igual que AVX2 pero con 16 carriles (dos vecinos por gather) y
+// máscaras de comparación.
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512vl,avx2,popcnt")
+static inline void target_libs_avx512(const int *b, int w, int h, int x, int y, int *libs) {
+    __m512i zero = _mm512_setzero_si512();
+    __m512i one = _mm512_set1_epi32(1);
+    __m256i dx8 = _mm256_loadu_si256((const __m256i *)dir_dx);
+    __m256i dy8 = _mm256_loadu_si256((const __m256i *)dir_dy);
+    __m512i dx = _mm512_inserti64x4(_mm512_castsi256_si512(dx8), dx8, 1);
+    __m512i dy = _mm512_inserti64x4(_mm512_castsi256_si512(dy8), dy8, 1);
+    __m512i tx = _mm512_add_epi32(_mm512_set1_epi32(x), dx);
+    __m512i ty = _mm512_add_epi32(_mm512_set1_epi32(y), dy);
+    __m512i vw = _mm512_set1_epi32(w);
+    __m512i vh = _mm512_set1_epi32(h);
+    __m512i acc = zero;
+    for (int k = 0; k < 8; k += 2) {
+        // Carriles 0-7: vecino k de cada destino; 8-15: vecino k + 1.
+        __m512i kx = _mm512_inserti64x4(_mm512_castsi256_si512(_mm256_set1_epi32(dir_dx[k])), _mm256_set1_epi32(dir_dx[k + 1]), 1);
+        __m512i ky = _mm512_inserti64x4(_mm512_castsi256_si512(_mm256_set1_epi32(dir_dy[k])), _mm256_set1_epi32(dir_dy[k + 1]), 1);
+        __m512i nx = _mm512_add_epi32(tx, kx);
+        __m512i ny = _mm512_add_epi32(ty, ky);
+        __mmask16 in = _mm512_cmplt_epu32_mask(nx, vw) & _mm512_cmplt_epu32_mask(ny, vh);
+        __m512i idx = _mm512_add_epi32(_mm512_mullo_epi32(ny, vw), nx);
+        __m512i v = _mm512_mask_i32gather_epi32(zero, in, idx, b, 4);
+        acc = _mm512_mask_add_epi32(acc, _mm512_cmpgt_epi32_mask(v, zero), acc, one);
+    }
+    __m256i sum = _mm256_add_epi32(_mm512_castsi512_si256(acc), _mm512_extracti64x4_epi64(acc, 1));
+    _mm256_storeu_si256((__m256i *)libs, sum);
+}
+
+#define KERNEL(name) name##_avx512
+#define KERNEL_NAME "avx512"
+#define TARGET_LIBS target_libs_avx512
+#include "sim_kernels.inc"
+#undef KERNEL
+#undef KERNEL_NAME
+#undef TARGET_LIBS
+#pragma GCC pop_options
+#endif
+
+// De mejor a peor.
+static const sim_kernels_t *const kernel_variants[] = {
+#ifdef SIM_X86
+    &table_avx512,
+    &table_avx2,
+    &table_sse42,
+#endif
+    &table_scalar
+};
+#define VARIANT_COUNT ((int)(sizeof(kernel_variants) / sizeof(kernel_variants[0])))
+
+// __builtin_cpu_supports lee cpuid y también verifica (xgetbv) que el SO
+// guarde los registros extendidos.
+static bool variant_supported(const sim_kernels_t *k) {
+#ifdef SIM_X86
+    __builtin_cpu_init();
+    if (k == &table_avx512) return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl");
+    if (k == &table_avx2) return __builtin_cpu_supports("avx2");
+    if (k == &table_sse42) return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+#endif
+    return k == &table_scalar;
+}
+
+static _Atomic(const sim_kernels_t *) active;
+static pthread_once_t active_once = PTHREAD_ONCE_INIT;
+
+static void select_default(void) {
+    if (active) return;
+    const char *env = getenv("CHOMP_KERNEL");
+    if (env && sim_kernel_select(env) == 0) return;
+    if (env) fprintf(stderr, "CHOMP_KERNEL=%s no disponible, se elige automáticamente\n", env);
+    if (sim_kernel_select(NULL) == -1) active = &table_scalar;
+}
+
+int sim_kernel_select(const char *name) {
+    bool any = !name || !*name || strcasecmp(name, "auto") == 0;
+    for (int i = 0; i < VARIANT_COUNT; i++) {
+        const sim_kernels_t *k = kernel_variants[i];
+        if (!any && strcasecmp(name, k->name) != 0) continue;
+        if (!variant_supported(k)) {
+            // En auto se sigue con la siguiente variante; una pedida por nombre falla.
+            if (any) continue;
+            return -1;
+        }
+        active = k;
+        return 0;
+    }
+    return -1;
+}
+
+const sim_kernels_t *sim_kernels(void) {
+    if (!active) pthread_once(&active_once, select_default);
+    return active;
+}
+
+bool sim_any_player_has_move(int *board, int width, int height, sim_player_t *players, int player_count) {
+    return sim_kernels()->any_player_has_move(board, width, height, players, player_count);
+}
+
+int sim_count_liberties(int *board, int width, int height, sim_player_t *players, int pid) {
+    return sim_kernels()->count_liberties(board, width, height, players, pid);
+}
+
+int sim_pick_policy_move(int *board, int width, int height, sim_player_t *players, int player_count, int pid, unsigned int *rng,
+                         const sim_policy_t *policy) {
+    return sim_kernels()->pick_policy_move(board, width, height, players, player_count, pid, rng, policy ? policy : &sim_policy_default);
+}
+
+void compute_voronoi_potential_buf(int *board, int width, int height, sim_player_t *players, int player_count, unsigned int *vor_out, sim_voronoi_ws_t *ws) {
+    sim_kernels()->voronoi(board, width, height, players, player_count, vor_out, ws);
+}
+
+// memcpy de glibc ya elige su variante por ifunc, no hace falta despacharla acá.
+void copy_board(int *dst, const int *src, int n) {
+    memcpy(dst, src, n * sizeof(int));
+}
+
+int simulate_playout(int *board, int width, int height, sim_player_t *players, int player_count, int start_next_player, unsigned int *rng,
+                     const sim_policy_t *policy) {
+    return sim_kernels()->playout(board, width, height, players, player_count, start_next_player, rng, policy ? policy : &sim_policy_default);
+}
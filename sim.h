@@ -0,0 +1,110 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "common.h"
+#include "game.h"
+#include <stdint.h>
+
+// Núcleos de simulación del player sobre tableros privados (sin shm).
+
+typedef struct { int x, y; unsigned int score; bool blocked; } sim_player_t;
+
+// Espacio de trabajo del BFS de Voronoi: distancias de 16 bits (UINT16_MAX =
+// sin alcanzar), dueño de 8 bits (-1 nadie, -2 empate) y una cola con cada
+// entrada empaquetada en 32 bits (x:14 | y:14 | jugador:4). Por eso los lados
+// del tablero no pueden pasar de SIM_MAX_SIDE.
+#define SIM_MAX_SIDE 16383
+
+typedef struct {
+    uint16_t *dist;
+    int8_t *owner;
+    uint32_t *queue;
+} sim_voronoi_ws_t;
+
+static inline uint32_t sim_vor_pack(int x, int y, int p) {
+    return (uint32_t)x | (uint32_t)y << 14 | (uint32_t)p << 28;
+}
+
+static inline unsigned int sim_rng_next(unsigned int *s) {
+    unsigned int x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+static inline bool sim_is_valid_move(int *board, int width, int height, sim_player_t *players, int pid, int d) {
+    int gx = players[pid].x;
+    int gy = players[pid].y;
+    int tx, ty;
+    game_target_from_dir(gx, gy, d, &tx, &ty);
+    if (tx < 0 || tx >= width || ty < 0 || ty >= height) {
+        return false;
+    }
+    return board[ty * width + tx] > 0;
+}
+
+static inline int sim_apply_move(int *board, int width, int height, sim_player_t *players, int pid, int d) {
+    int gx = players[pid].x;
+    int gy = players[pid].y;
+    int tx, ty;
+    game_target_from_dir(gx, gy, d, &tx, &ty);
+    if (tx < 0 || tx >= width || ty < 0 || ty >= height) {
+        return -1;
+    }
+    int idx = ty * width + tx;
+    int reward = board[idx];
+    if (reward <= 0) {
+        return -1;
+    }
+    players[pid].score += (unsigned int)reward;
+    board[idx] = -(pid + 1);
+    players[pid].x = tx;
+    players[pid].y = ty;
+    players[pid].blocked = false;
+    return reward;
+}
+
+// Política de las playouts: con probabilidad epsilon/256 una jugada al azar;
+// si no, la de mayor recompensa + liberty_weight * libertades del destino.
+typedef struct {
+    double liberty_weight;
+    unsigned int epsilon;
+} sim_policy_t;
+
+#define SIM_POLICY_DEFAULT { .liberty_weight = 1.5, .epsilon = 30 }
+
+extern const sim_policy_t sim_policy_default;
+
+bool sim_any_player_has_move(int *board, int width, int height, sim_player_t *players, int player_count);
+int sim_count_liberties(int *board, int width, int height, sim_player_t *players, int pid);
+// policy NULL usa sim_policy_default.
+int sim_pick_policy_move(int *board, int width, int height, sim_player_t *players, int player_count, int pid, unsigned int *rng,
+                         const sim_policy_t *policy);
+void compute_voronoi_potential_buf(int *board, int width, int height, sim_player_t *players, int player_count, unsigned int *vor_out, sim_voronoi_ws_t *ws);
+void copy_board(int *dst, const int *src, int n);
+
+// Juega hasta que nadie pueda moverse; devuelve la cantidad de jugadas aplicadas.
+int simulate_playout(int *board, int width, int height, sim_player_t *players, int player_count, int start_next_player, unsigned int *rng,
+                     const sim_policy_t *policy);
+
+// Variantes de los núcleos por ISA (scalar, sse4.2, avx2, avx512), todas con
+// resultados idénticos. Las funciones de arriba despachan a la activa, que se
+// elige la primera vez con cpuid o con CHOMP_KERNEL.
+typedef struct {
+    const char *name;
+    int (*count_liberties)(int *board, int width, int height, sim_player_t *players, int pid);
+    bool (*any_player_has_move)(int *board, int width, int height, sim_player_t *players, int player_count);
+    int (*pick_policy_move)(int *board, int width, int height, sim_player_t *players, int player_count, int pid, unsigned int *rng,
+                            const sim_policy_t *policy);
+    void (*voronoi)(int *board, int width, int height, sim_player_t *players, int player_count, unsigned int *vor_out, sim_voronoi_ws_t *ws);
+    int (*playout)(int *board, int width, int height, sim_player_t *players, int player_count, int start_next_player, unsigned int *rng,
+                   const sim_policy_t *policy);
+} sim_kernels_t;
+
+const sim_kernels_t *sim_kernels(void);
+// name NULL o "auto" elige la mejor soportada; -1 si no existe o la CPU no la soporta.
+int sim_kernel_select(const char *name);
+
+#endif
@@ -0,0 +1,48 @@
+#include "spawn.h"
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+extern char **environ;
+
+int set_cloexec(int fd) {
+    int flags = fcntl(fd, F_GETFD);
+    if (flags == -1) return -1;
+    return fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+}
+
+pid_t spawn_process(const char *path, char *const argv[], int stdout_fd, double *elapsed_us) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    posix_spawn_file_actions_t actions;
+    int rc = posix_spawn_file_actions_init(&actions);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    if (stdout_fd != -1 && stdout_fd != STDOUT_FILENO) {
+        rc = posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDOUT_FILENO);
+        if (rc != 0) {
+            posix_spawn_file_actions_destroy(&actions);
+            errno = rc;
+            return -1;
+        }
+    }
+
+    pid_t pid;
+    rc = posix_spawn(&pid, path, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (elapsed_us) {
+        *elapsed_us = (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+    }
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return pid;
+}
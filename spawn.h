@@ -0,0 +1,14 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include <sys/types.h>
+
+// Lanza path con posix_spawn (vfork/CLONE_VFORK en glibc, sin copiar las tablas de páginas).
+// Si stdout_fd != -1 se redirige a STDOUT_FILENO en el hijo. El resto de los
+// descriptores que no deban heredarse tienen que estar marcados FD_CLOEXEC.
+// Devuelve el pid o -1 con errno; si elapsed_us no es NULL guarda cuánto tardó.
+pid_t spawn_process(const char *path, char *const argv[], int stdout_fd, double *elapsed_us);
+
+int set_cloexec(int fd);
+
+#endif
@@ -0,0 +1,578 @@
+#include "strategy.h"
+#include "sim.h"
+#include "game.h"
+#include "arena.h"
+#include "absearch.h"
+#include "fenwick.h"
+#include <stdint.h>
+#include <limits.h>
+#include <float.h>
+
+// auto: alfa-beta con hasta AB_AUTO_CELLS celdas o AB_AUTO_FREE libres.
+#define AB_AUTO_CELLS 64
+#define AB_AUTO_FREE 40
+// Sin tiempo, el presupuesto de alfa-beta es en nodos: max_sims * AB_NODES_PER_SIM.
+#define AB_NODES_PER_SIM 2
+
+struct strategy {
+    strategy_stats_t stats;
+    int width;
+    int height;
+    int cells;
+    int player_cap;
+    unsigned int rng;
+    // Todo el espacio de trabajo sale de una arena propia de esta instancia
+    // (una por hilo de búsqueda): nada se reserva durante strategy_decide.
+    arena_t arena;
+    int *board_snapshot;
+    sim_player_t *players_snapshot;
+    int *board_sim;
+    sim_player_t *players_sim;
+    unsigned int *vor_tmp;
+    sim_voronoi_ws_t vor;
+    // Índice de recompensas libres, al día con la última posición y puntaje
+    // vistos de cada jugador.
+    fenwick2d_t rewards;
+    sim_player_t rewards_players[MAX_PLAYERS];
+    int rewards_player_count;
+    bool rewards_valid;
+    perfctr_t *prof_playout;
+    perfctr_t *prof_voronoi;
+    strategy_params_t params;
+    strategy_engine_t engine;
+    ab_search_t *ab;
+    const evalnet_t *net;
+    evalnet_t *net_owned;
+    const book_t *book;
+    book_t *book_owned;
+};
+
+
+static double elapsed_ms_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static uint64_t elapsed_ns_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - start->tv_sec) * 1000000000ull + (uint64_t)now.tv_nsec - (uint64_t)start->tv_nsec;
+}
+
+strategy_t *strategy_create(int width, int height, int player_count, unsigned int seed) {
+    if (width <= 0 || height <= 0 || player_count <= 0 || width > SIM_MAX_SIDE || height > SIM_MAX_SIDE) {
+        errno = EINVAL;
+        return NULL;
+    }
+    strategy_t *s = calloc(1, sizeof(strategy_t));
+    if (!s) return NULL;
+
+    int cells = width * height;
+    s->width = width;
+    s->height = height;
+    s->cells = cells;
+    s->player_cap = player_count;
+    s->rng = seed ? seed : 0x9e3779b9u;
+    s->params = (strategy_params_t)STRATEGY_PARAMS_DEFAULT;
+    const char *params_env = getenv("CHOMP_PARAMS");
+    if (params_env && strategy_params_parse(params_env, &s->params) == -1) {
+        fprintf(stderr, "CHOMP_PARAMS=%s inválido, se usan los valores por defecto\n", params_env);
+        s->params = (strategy_params_t)STRATEGY_PARAMS_DEFAULT;
+    }
+    size_t board_bytes = sizeof(int) * (size_t)cells;
+    size_t players_bytes = sizeof(sim_player_t) * (size_t)player_count;
+    size_t total = 2 * arena_round(board_bytes) + 2 * arena_round(players_bytes) +
+                   arena_round(sizeof(unsigned int) * (size_t)player_count) +
+                   arena_round(sizeof(uint16_t) * (size_t)cells) + arena_round(sizeof(int8_t) * (size_t)cells) +
+                   arena_round(sizeof(uint32_t) * (size_t)cells) +
+                   arena_round(fenwick2d_bytes(width, height));
+    if (arena_init(&s->arena, total, getenv("CHOMP_HUGEPAGES") != NULL) == -1) {
+        free(s);
+        return NULL;
+    }
+    s->board_snapshot = arena_push(&s->arena, board_bytes);
+    s->players_snapshot = arena_push(&s->arena, players_bytes);
+    s->board_sim = arena_push(&s->arena, board_bytes);
+    s->players_sim = arena_push(&s->arena, players_bytes);
+    s->vor_tmp = arena_push(&s->arena, sizeof(unsigned int) * (size_t)player_count);
+    s->vor.dist = arena_push(&s->arena, sizeof(uint16_t) * (size_t)cells);
+    s->vor.owner = arena_push(&s->arena, sizeof(int8_t) * (size_t)cells);
+    s->vor.queue = arena_push(&s->arena, sizeof(uint32_t) * (size_t)cells);
+    fenwick2d_init(&s->rewards, width, height, arena_push(&s->arena, fenwick2d_bytes(width, height)));
+
+    const char *eval_env = getenv("CHOMP_EVAL");
+    if (eval_env) {
+        s->net_owned = aligned_alloc(32, sizeof(evalnet_t));
+        if (s->net_owned && evalnet_load(s->net_owned, eval_env) == 0) {
+            s->net = s->net_owned;
+        } else {
+            perror(eval_env);
+            fprintf(stderr, "CHOMP_EVAL inválido, se usan playouts\n");
+        }
+    }
+
+    const char *book_env = getenv("CHOMP_BOOK");
+    if (book_env) {
+        s->book_owned = book_open(book_env);
+        if (s->book_owned) {
+            s->book = s->book_owned;
+        } else {
+            perror(book_env);
+            fprintf(stderr, "CHOMP_BOOK inválido, se juega sin libro\n");
+        }
+    }
+
+    strategy_engine_t engine = STRATEGY_ENGINE_MC;
+    const char *engine_env = getenv("CHOMP_ENGINE");
+    const char *threads_env = getenv("CHOMP_AB_THREADS");
+    if (engine_env && strategy_engine_parse(engine_env, &engine) == -1) {
+        fprintf(stderr, "CHOMP_ENGINE=%s desconocido, se usa mc\n", engine_env);
+    }
+    if (strategy_set_engine(s, engine, threads_env ? atoi(threads_env) : 1) == -1) {
+        strategy_destroy(s);
+        return NULL;
+    }
+    return s;
+}
+
+void strategy_destroy(strategy_t *s) {
+    if (!s) return;
+    ab_destroy(s->ab);
+    free(s->net_owned);
+    book_close(s->book_owned);
+    arena_destroy(&s->arena);
+    free(s);
+}
+
+#define SYNC_MAX_STEPS 64
+
+// Resta del índice las celdas que p tomó desde la última vez: son las que el
+// tablero marca como suyas y el índice todavía cuenta libres, y forman un
+// camino que termina en su posición actual. Devuelve lo restado, o -1 si el
+// camino es más largo que SYNC_MAX_STEPS.
+static long take_path(strategy_t *s, const int *board, int p, int x, int y) {
+    int stack[SYNC_MAX_STEPS];
+    int top = 0;
+    long taken = 0;
+    int steps = 0;
+    stack[top++] = y * s->width + x;
+    while (top > 0) {
+        int c = stack[--top];
+        int cx = c % s->width, cy = c / s->width;
+        unsigned int v = fenwick2d_rect(&s->rewards, cx, cy, cx, cy);
+        if (v == 0) continue;
+        if (++steps > SYNC_MAX_STEPS) return -1;
+        fenwick2d_add(&s->rewards, cx, cy, -(int)v);
+        taken += v;
+        for (int d = 0; d < 8; d++) {
+            int nx, ny;
+            game_target_from_dir(cx, cy, d, &nx, &ny);
+            if (nx < 0 || nx >= s->width || ny < 0 || ny >= s->height) continue;
+            if (board[ny * s->width + nx] != -(p + 1)) continue;
+            if (top == SYNC_MAX_STEPS) return -1;
+            stack[top++] = ny * s->width + nx;
+        }
+    }
+    return taken;
+}
+
+// Lleva el índice al tablero actual sin recorrerlo entero: sólo se miran los
+// caminos de quienes se movieron, y lo restado tiene que coincidir con lo que
+// subió su puntaje. Si no cierra, o empezó otra partida (todos en cero o un
+// puntaje que baja), se reconstruye en O(celdas).
+static void sync_rewards(strategy_t *s, const int *board, const sim_player_t *players, int player_count) {
+    bool rebuild = !s->rewards_valid || player_count != s->rewards_player_count;
+    bool all_zero = true;
+    for (int p = 0; p < player_count && !rebuild; p++) {
+        const sim_player_t *now = &players[p];
+        sim_player_t *was = &s->rewards_players[p];
+        if (now->score != 0) all_zero = false;
+        if (now->x == was->x && now->y == was->y && now->score == was->score) continue;
+        if (now->score < was->score || board[now->y * s->width + now->x] != -(p + 1) ||
+            take_path(s, board, p, now->x, now->y) != (long)(now->score - was->score)) {
+            rebuild = true;
+            break;
+        }
+        *was = *now;
+    }
+    if (rebuild || all_zero) {
+        fenwick2d_build(&s->rewards, board);
+        memcpy(s->rewards_players, players, sizeof(sim_player_t) * (size_t)player_count);
+        s->rewards_player_count = player_count;
+        s->rewards_valid = true;
+    }
+}
+
+int strategy_decide(strategy_t *s, const strategy_state_t *st, const strategy_budget_t *budget) {
+    int gwidth = st->width;
+    int gheight = st->height;
+    int gplayer_count = st->player_count;
+    int my_index = st->my_index;
+    int cells = gwidth * gheight;
+    const int *board_snapshot = st->board;
+    const sim_player_t *players_snapshot = st->players;
+    memset(&s->stats, 0, sizeof(s->stats));
+    if (cells > s->cells || gplayer_count > s->player_cap) {
+        return -1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int time_ms = budget ? budget->time_ms : 0;
+
+    int gx = players_snapshot[my_index].x;
+    int gy = players_snapshot[my_index].y;
+
+    int valid_dirs[8];
+    int valid_count = 0;
+    int immediate_vals[8];
+    for (int d = 0; d < 8; d++) {
+        int tx, ty;
+        game_target_from_dir(gx, gy, d, &tx, &ty);
+        if (tx < 0 || tx >= gwidth || ty < 0 || ty >= gheight) {
+            continue;
+        }
+        int cell = board_snapshot[ty * gwidth + tx];
+        if (cell <= 0) {
+            continue;
+        }
+        valid_dirs[valid_count] = d;
+        immediate_vals[valid_count] = cell;
+        s->stats.candidates[valid_count] = (strategy_candidate_t){ .dir = d, .immediate = cell, .value = cell };
+        valid_count++;
+    }
+    s->stats.candidate_count = valid_count;
+    if (valid_count == 0) {
+        return -1;
+    }
+
+    int free_cells = 0;
+    for (int i = 0; i < cells; i++) {
+        if (board_snapshot[i] > 0) {
+            free_cells++;
+        }
+    }
+    int opening_threshold = (int)(cells * s->params.opening_free);
+    if (s->book && free_cells >= opening_threshold) {
+        int dir = book_probe(s->book, board_snapshot, gwidth, gheight, players_snapshot, gplayer_count, my_index);
+        for (int i = 0; i < valid_count; i++) {
+            if (valid_dirs[i] == dir) {
+                s->stats.book = true;
+                s->stats.best_ns = elapsed_ns_since(&start);
+                return dir;
+            }
+        }
+    }
+
+    if (s->ab && gwidth == s->width && gheight == s->height && gplayer_count == s->player_cap &&
+        (s->engine == STRATEGY_ENGINE_AB || cells <= AB_AUTO_CELLS || free_cells <= AB_AUTO_FREE)) {
+        unsigned long max_nodes = 0;
+        if (budget && budget->max_sims > 0) max_nodes = (unsigned long)budget->max_sims * AB_NODES_PER_SIM;
+        else if (time_ms <= 0) max_nodes = 2000ul * AB_NODES_PER_SIM;
+        ab_result_t res;
+        int dir = ab_search(s->ab, board_snapshot, players_snapshot, my_index, time_ms, max_nodes, &res);
+        s->stats.alphabeta = true;
+        s->stats.nodes = res.nodes;
+        s->stats.max_depth = res.depth;
+        s->stats.best_ns = res.best_ns;
+        for (int i = 0; i < valid_count; i++) {
+            int v = res.value[valid_dirs[i]];
+            if (v != INT_MIN) s->stats.candidates[i].value = v;
+        }
+        return dir;
+    }
+
+    if (free_cells >= opening_threshold) {
+        double bestv = -DBL_MAX;
+        int bests[8];
+        int bc = 0;
+        bool use_index = gwidth == s->width && gheight == s->height;
+        if (use_index) sync_rewards(s, board_snapshot, players_snapshot, gplayer_count);
+        for (int i = 0; i < valid_count; i++) {
+            int d = valid_dirs[i];
+            int tx, ty;
+            game_target_from_dir(gx, gy, d, &tx, &ty);
+            int neigh_sum = 0;
+            if (use_index) {
+                neigh_sum = (int)fenwick2d_around(&s->rewards, tx, ty, 1) - immediate_vals[i];
+            } else {
+                for (int dd = 0; dd < 8; dd++) {
+                    int nx, ny;
+                    game_target_from_dir(tx, ty, dd, &nx, &ny);
+                    if (nx < 0 || nx >= gwidth || ny < 0 || ny >= gheight) {
+                        continue;
+                    }
+                    int v = board_snapshot[ny * gwidth + nx];
+                    if (v > 0) {
+                        neigh_sum += v;
+                    }
+                }
+            }
+            double val = (double)immediate_vals[i] + s->params.neighbour_weight * (double)neigh_sum;
+            s->stats.candidates[i].value = val;
+            if (val > bestv) {
+                bestv = val;
+                bc = 0;
+                bests[bc++] = d;
+            } else if (val == bestv) {
+                bests[bc++] = d;
+            }
+        }
+        s->stats.opening = true;
+        s->stats.best_ns = elapsed_ns_since(&start);
+        return bests[sim_rng_next(&s->rng) % bc];
+    }
+
+    if (s->net) {
+        double bestv = -DBL_MAX;
+        int bests[8];
+        int bc = 0;
+        float features[EVALNET_INPUTS];
+        for (int i = 0; i < valid_count; i++) {
+            int d = valid_dirs[i];
+            copy_board(s->board_sim, board_snapshot, cells);
+            memcpy(s->players_sim, players_snapshot, sizeof(sim_player_t) * gplayer_count);
+            sim_apply_move(s->board_sim, gwidth, gheight, s->players_sim, my_index, d);
+            if (s->prof_voronoi) perfctr_resume(s->prof_voronoi);
+            compute_voronoi_potential_buf(s->board_sim, gwidth, gheight, s->players_sim, gplayer_count, s->vor_tmp, &s->vor);
+            if (s->prof_voronoi) perfctr_pause(s->prof_voronoi);
+            s->stats.voronoi_cells += (unsigned long)cells;
+            evalnet_features(s->board_sim, gwidth, gheight, s->players_sim, gplayer_count, my_index, s->vor_tmp, features);
+            double val = evalnet_predict(s->net, features);
+            s->stats.candidates[i].value = val;
+            s->stats.candidates[i].voronoi = s->vor_tmp[my_index];
+            if (val > bestv) {
+                bestv = val;
+                bc = 0;
+                bests[bc++] = d;
+                s->stats.best_ns = elapsed_ns_since(&start);
+            } else if (val == bestv) {
+                bests[bc++] = d;
+            }
+        }
+        s->stats.learned = true;
+        return bests[sim_rng_next(&s->rng) % bc];
+    }
+
+    int K = s->params.top_k;
+    if (valid_count < K) {
+        K = valid_count;
+    }
+    int idxs[8];
+    for (int i = 0; i < valid_count; i++) idxs[i] = i;
+    for (int i = 0; i < K; i++) {
+        int best = i;
+        for (int j = i + 1; j < valid_count; j++) {
+            if (immediate_vals[idxs[j]] > immediate_vals[idxs[best]]) {
+                best = j;
+            }
+        }
+        int tmp = idxs[i];
+        idxs[i] = idxs[best];
+        idxs[best] = tmp;
+    }
+
+    int sims_per_candidate = 400;
+    if (cells <= 25) sims_per_candidate = 500;
+    else if (cells <= 100) sims_per_candidate = 300;
+    else if (cells <= 400) sims_per_candidate = 150;
+    else sims_per_candidate = 80;
+    int max_total_sims = (budget && budget->max_sims > 0) ? budget->max_sims : 2000;
+    long total_sims = (long)sims_per_candidate * K;
+    if (total_sims > max_total_sims) sims_per_candidate = max_total_sims / K;
+    if (sims_per_candidate < 5) sims_per_candidate = 5;
+
+    double best_avg = -DBL_MAX;
+    int bests2[8];
+    int bestc2 = 0;
+    double candidate_avgs[8];
+    for (int i = 0; i < valid_count; i++) candidate_avgs[i] = (double)immediate_vals[i];
+
+    bool out_of_time = false;
+    for (int t = 0; t < K && !out_of_time; t++) {
+        int ci = idxs[t];
+        int cand = valid_dirs[ci];
+        double sum_score = 0.0;
+        int done = 0;
+        for (int s_i = 0; s_i < sims_per_candidate; s_i++) {
+            if (time_ms > 0 && (s_i & 15) == 15 && elapsed_ms_since(&start) >= time_ms) {
+                out_of_time = true;
+                break;
+            }
+            copy_board(s->board_sim, board_snapshot, cells);
+            memcpy(s->players_sim, players_snapshot, sizeof(sim_player_t) * gplayer_count);
+            int immediate = sim_apply_move(s->board_sim, gwidth, gheight, s->players_sim, my_index, cand);
+            if (immediate < 0) {
+                s->players_sim[my_index].blocked = true;
+            }
+            int next = (my_index + 1) % gplayer_count;
+            if (s->prof_playout) perfctr_resume(s->prof_playout);
+            int depth = simulate_playout(s->board_sim, gwidth, gheight, s->players_sim, gplayer_count, next, &s->rng, &s->params.policy);
+            if (s->prof_playout) perfctr_pause(s->prof_playout);
+            s->stats.sims++;
+            s->stats.playout_moves += (unsigned long)depth;
+            if (depth > s->stats.max_depth) s->stats.max_depth = depth;
+            sum_score += (double)s->players_sim[my_index].score;
+            done++;
+        }
+        if (done == 0) {
+            break;
+        }
+        double avg = sum_score / (double)done;
+        candidate_avgs[ci] = avg;
+        s->stats.candidates[ci].sims = (unsigned long)done;
+        s->stats.candidates[ci].score_sum = sum_score;
+        s->stats.candidates[ci].value = avg;
+        if (avg > best_avg) {
+            best_avg = avg;
+            s->stats.best_ns = elapsed_ns_since(&start);
+            bestc2 = 0;
+            bests2[bestc2++] = cand;
+        } else if (avg == best_avg) {
+            bests2[bestc2++] = cand;
+        }
+    }
+    if (bestc2 == 0) {
+        return valid_dirs[idxs[0]];
+    }
+
+    int pick = bests2[sim_rng_next(&s->rng) % bestc2];
+    if (bestc2 > 1) {
+        double best_comb = -DBL_MAX;
+        int topk = bestc2;
+        if (topk > 4) topk = 4;
+        for (int t = 0; t < topk; t++) {
+            int cand = bests2[t];
+            copy_board(s->board_sim, board_snapshot, cells);
+            memcpy(s->players_sim, players_snapshot, sizeof(sim_player_t) * gplayer_count);
+            sim_apply_move(s->board_sim, gwidth, gheight, s->players_sim, my_index, cand);
+            if (s->prof_voronoi) perfctr_resume(s->prof_voronoi);
+            compute_voronoi_potential_buf(s->board_sim, gwidth, gheight, s->players_sim, gplayer_count, s->vor_tmp, &s->vor);
+            if (s->prof_voronoi) perfctr_pause(s->prof_voronoi);
+            s->stats.voronoi_cells += (unsigned long)cells;
+            double my_vor = (double)s->vor_tmp[my_index];
+            for (int i = 0; i < valid_count; i++) {
+                if (valid_dirs[i] == cand) s->stats.candidates[i].voronoi = s->vor_tmp[my_index];
+            }
+            double gamma = s->params.voronoi_gamma;
+            double avg = candidate_avgs[t];
+            double combined = avg + gamma * my_vor;
+            if (combined > best_comb) {
+                best_comb = combined;
+                if (pick != cand) s->stats.best_ns = elapsed_ns_since(&start);
+                pick = cand;
+            }
+        }
+    }
+    return pick;
+}
+
+int strategy_set_engine(strategy_t *s, strategy_engine_t engine, int threads) {
+    ab_destroy(s->ab);
+    s->ab = NULL;
+    s->engine = engine;
+    if (engine == STRATEGY_ENGINE_MC) return 0;
+    s->ab = ab_create(s->width, s->height, s->player_cap, threads);
+    if (!s->ab) return -1;
+    ab_set_eval(s->ab, s->net);
+    return 0;
+}
+
+void strategy_set_book(strategy_t *s, const book_t *book) {
+    s->book = book;
+}
+
+void strategy_set_eval(strategy_t *s, const evalnet_t *net) {
+    s->net = net;
+    if (s->ab) ab_set_eval(s->ab, net);
+}
+
+void strategy_set_params(strategy_t *s, const strategy_params_t *p) {
+    s->params = *p;
+}
+
+const strategy_params_t *strategy_get_params(const strategy_t *s) {
+    return &s->params;
+}
+
+int strategy_params_parse(const char *spec, strategy_params_t *p) {
+    strategy_params_t out = *p;
+    const char *c = spec;
+    while (*c) {
+        const char *eq = strchr(c, '=');
+        if (!eq) return -1;
+        size_t len = (size_t)(eq - c);
+        char *end;
+        double v = strtod(eq + 1, &end);
+        if (end == eq + 1 || (*end != '\0' && *end != ',')) return -1;
+        if (len == 3 && strncmp(c, "lib", 3) == 0) {
+            out.policy.liberty_weight = v;
+        } else if (len == 3 && strncmp(c, "eps", 3) == 0 && v >= 0 && v <= 256) {
+            out.policy.epsilon = (unsigned int)v;
+        } else if (len == 4 && strncmp(c, "open", 4) == 0 && v >= 0 && v <= 1) {
+            out.opening_free = v;
+        } else if (len == 5 && strncmp(c, "neigh", 5) == 0) {
+            out.neighbour_weight = v;
+        } else if (len == 5 && strncmp(c, "gamma", 5) == 0) {
+            out.voronoi_gamma = v;
+        } else if (len == 1 && c[0] == 'k' && v >= 1 && v <= 8) {
+            out.top_k = (int)v;
+        } else {
+            return -1;
+        }
+        c = *end == ',' ? end + 1 : end;
+    }
+    *p = out;
+    return 0;
+}
+
+int strategy_params_format(const strategy_params_t *p, char *buf, size_t size) {
+    return snprintf(buf, size, "lib=%g,eps=%u,open=%g,neigh=%g,gamma=%g,k=%d", p->policy.liberty_weight,
+                    p->policy.epsilon, p->opening_free, p->neighbour_weight, p->voronoi_gamma, p->top_k);
+}
+
+int strategy_engine_parse(const char *name, strategy_engine_t *out) {
+    if (strcmp(name, "mc") == 0) *out = STRATEGY_ENGINE_MC;
+    else if (strcmp(name, "ab") == 0) *out = STRATEGY_ENGINE_AB;
+    else if (strcmp(name, "auto") == 0) *out = STRATEGY_ENGINE_AUTO;
+    else return -1;
+    return 0;
+}
+
+void strategy_set_profile(strategy_t *s, perfctr_t *playout, perfctr_t *voronoi) {
+    s->prof_playout = playout;
+    s->prof_voronoi = voronoi;
+}
+
+const strategy_stats_t *strategy_last_stats(const strategy_t *s) {
+    return &s->stats;
+}
+
+int *strategy_board_snapshot(strategy_t *s) {
+    return s->board_snapshot;
+}
+
+sim_player_t *strategy_players_snapshot(strategy_t *s) {
+    return s->players_snapshot;
+}
+
+static void *plugin_create(int width, int height, int player_count, unsigned int seed) {
+    return strategy_create(width, height, player_count, seed);
+}
+
+static void plugin_destroy(void *ctx) {
+    strategy_destroy(ctx);
+}
+
+static int plugin_decide(void *ctx, const strategy_state_t *st, const strategy_budget_t *budget) {
+    return strategy_decide(ctx, st, budget);
+}
+
+const strategy_plugin_t chomp_strategy = {
+    STRATEGY_ABI_VERSION,
+    "montecarlo",
+    plugin_create,
+    plugin_destroy,
+    plugin_decide
+};
@@ -0,0 +1,148 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include "common.h"
+#include "sim.h"
+#include "perfctr.h"
+#include "evalnet.h"
+#include "book.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ABI de estrategias: el player la usa enlazada estáticamente y el master
+// la carga con dlopen desde un .so (símbolo STRATEGY_PLUGIN_SYMBOL).
+#define STRATEGY_ABI_VERSION 1
+#define STRATEGY_PLUGIN_SYMBOL "chomp_strategy"
+
+// Vista de sólo lectura de una posición; el tablero no se modifica.
+typedef struct {
+    int width;
+    int height;
+    int player_count;
+    int my_index;
+    const int *board;
+    const sim_player_t *players;
+} strategy_state_t;
+
+// max_sims == 0 usa el presupuesto por tamaño de tablero; time_ms == 0 no limita por tiempo.
+typedef struct {
+    int max_sims;
+    int time_ms;
+} strategy_budget_t;
+
+typedef struct {
+    int abi_version;
+    const char *name;
+    void *(*create)(int width, int height, int player_count, unsigned int seed);
+    void (*destroy)(void *ctx);
+    int (*decide)(void *ctx, const strategy_state_t *st, const strategy_budget_t *budget);
+} strategy_plugin_t;
+
+// Una jugada candidata: value es el puntaje con el que compitió (heurística de
+// apertura o media de las playouts); voronoi sólo se calcula para desempatar.
+typedef struct {
+    int dir;
+    int immediate;
+    unsigned long sims;
+    double score_sum;
+    double value;
+    unsigned int voronoi;
+} strategy_candidate_t;
+
+// Estadísticas de la última llamada a strategy_decide.
+typedef struct {
+    unsigned long sims;
+    unsigned long playout_moves;
+    unsigned long voronoi_cells;
+    int max_depth;
+    bool opening;
+    int candidate_count;
+    strategy_candidate_t candidates[8];
+    uint64_t best_ns;  // desde el inicio de la búsqueda hasta que la jugada elegida pasó a ser la mejor
+    bool alphabeta;    // decidió la búsqueda alfa-beta: max_depth es la última iteración completa
+    bool learned;      // las candidatas se valuaron con el evaluador aprendido (value = margen previsto)
+    bool book;         // la jugada salió del libro de aperturas
+    unsigned long nodes;
+} strategy_stats_t;
+
+// Motor de búsqueda: Monte Carlo (por defecto), alfa-beta paranoico, o auto,
+// que usa alfa-beta en tableros chicos y en el final de la partida.
+typedef enum {
+    STRATEGY_ENGINE_MC,
+    STRATEGY_ENGINE_AB,
+    STRATEGY_ENGINE_AUTO
+} strategy_engine_t;
+
+// Constantes de la heurística, ajustables en tiempo de ejecución (sweep las
+// barre en paralelo). Los valores por defecto son los de siempre.
+typedef struct {
+    sim_policy_t policy;        // playouts: peso de libertades y epsilon (de 256)
+    double opening_free;        // fracción de celdas libres hasta la que dura la apertura (y el libro)
+    double neighbour_weight;    // peso de la recompensa vecina en la apertura
+    double voronoi_gamma;       // peso del territorio al desempatar las mejores medias
+    int top_k;                  // candidatas (por recompensa inmediata) que reciben playouts
+} strategy_params_t;
+
+#define STRATEGY_PARAMS_DEFAULT { .policy = SIM_POLICY_DEFAULT, .opening_free = 0.55, .neighbour_weight = 0.25, \
+                                  .voronoi_gamma = 0.03, .top_k = 3 }
+
+typedef struct strategy strategy_t;
+
+strategy_t *strategy_create(int width, int height, int player_count, unsigned int seed);
+void strategy_destroy(strategy_t *s);
+
+// Devuelve la dirección elegida (0..7) o -1 si no hay movimientos válidos.
+int strategy_decide(strategy_t *s, const strategy_state_t *st, const strategy_budget_t *budget);
+
+const strategy_stats_t *strategy_last_stats(const strategy_t *s);
+
+// Cambia el motor; threads > 1 usa Lazy SMP en alfa-beta. strategy_create ya
+// aplica CHOMP_ENGINE (mc|ab|auto) y CHOMP_AB_THREADS. -1 sin memoria.
+int strategy_set_engine(strategy_t *s, strategy_engine_t engine, int threads);
+// Evaluador aprendido en lugar de las playouts (y de Voronoi en las hojas de
+// alfa-beta); NULL vuelve a las playouts. El evalnet_t sigue siendo del
+// llamador. strategy_create ya carga CHOMP_EVAL=<archivo> si está.
+void strategy_set_eval(strategy_t *s, const evalnet_t *net);
+// Libro de aperturas consultado mientras dura la apertura (opening_free: 55%
+// de celdas libres por defecto). NULL lo desactiva; sigue siendo del
+// llamador. strategy_create ya abre CHOMP_BOOK=<archivo> si está.
+void strategy_set_book(strategy_t *s, const book_t *book);
+// strategy_create ya aplica CHOMP_PARAMS (mismo formato que strategy_params_parse).
+void strategy_set_params(strategy_t *s, const strategy_params_t *p);
+const strategy_params_t *strategy_get_params(const strategy_t *s);
+// "lib=1.5,eps=30,open=0.55,neigh=0.25,gamma=0.03,k=3" (cualquier subconjunto,
+// el resto queda como está en p). -1 con un nombre o valor inválido.
+int strategy_params_parse(const char *spec, strategy_params_t *p);
+// Escribe p en el mismo formato; devuelve lo que devolvería snprintf.
+int strategy_params_format(const strategy_params_t *p, char *buf, size_t size);
+// "mc", "ab" o "auto"; -1 si no es ninguno.
+int strategy_engine_parse(const char *name, strategy_engine_t *out);
+
+// Buffers de la arena de la instancia para copiar ahí el estado antes de
+// strategy_decide (width * height celdas y player_count jugadores).
+int *strategy_board_snapshot(strategy_t *s);
+sim_player_t *strategy_players_snapshot(strategy_t *s);
+
+// Opcional: acumula contadores de hardware sólo durante las playouts y el BFS
+// de Voronoi (NULL desactiva). Los perfctr_t siguen siendo del llamador.
+void strategy_set_profile(strategy_t *s, perfctr_t *playout, perfctr_t *voronoi);
+
+static inline void strategy_players_from_state(sim_player_t *dst, const player_t *src, unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+        dst[i].x = (int)src[i].x;
+        dst[i].y = (int)src[i].y;
+        dst[i].score = src[i].score;
+        dst[i].blocked = src[i].blocked;
+    }
+}
+
+extern const strategy_plugin_t chomp_strategy;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,325 @@
+#include "common.h"
+#include "game.h"
+#include "strategy.h"
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+
+// Barrido de las constantes de la heurística: cada configuración juega contra
+// la base (las demás sillas) sobre las mismas semillas de tablero, rotando la
+// silla para no favorecer a nadie por la posición inicial. Los pares
+// (configuración, semilla) se reparten entre hilos; cada semilla aporta una
+// muestra (margen y victorias promediados sobre las rotaciones) y el ranking
+// sale con intervalos de confianza del 95%. Como todas juegan los mismos
+// tableros, la diferencia con la base se mide además semilla a semilla
+// (pareada), sin la parte de la varianza que depende sólo del tablero.
+
+#define SWEEP_MAX_CONFIGS 256
+#define SWEEP_MAX_AXES 6
+#define SWEEP_Z95 1.96
+
+typedef struct {
+    int width;
+    int height;
+    int players;
+    int seeds;
+    int first_seed;
+    int threads;
+    strategy_budget_t budget;
+    strategy_params_t base;
+} sweep_opts_t;
+
+typedef struct {
+    strategy_params_t params;
+    char name[128];
+    bool is_base;
+    double margin;
+    double margin_ci;
+    double win;
+    double win_ci;
+    double delta;
+    double delta_ci;
+} sweep_config_t;
+
+// margins y wins: una fila de o->seeds muestras por configuración; cada
+// trabajo escribe su celda, así que no hace falta lock.
+typedef struct {
+    const sweep_opts_t *o;
+    sweep_config_t *configs;
+    int config_count;
+    double *margins;
+    double *wins;
+    _Atomic int next_job;
+    _Atomic unsigned long games;
+    _Atomic int failed;
+} sweep_t;
+
+typedef struct {
+    const sweep_opts_t *o;
+    strategy_t **seats;
+    sim_player_t *sp;
+} sweep_game_t;
+
+static int sweep_decide(void *arg, const game_state_t *gs, int i) {
+    sweep_game_t *g = arg;
+    const sweep_opts_t *o = g->o;
+    strategy_players_from_state(g->sp, gs->players, o->players);
+    strategy_state_t st = { .width = o->width, .height = o->height, .player_count = o->players, .my_index = i,
+                            .board = gs->board, .players = g->sp };
+    return strategy_decide(g->seats[i], &st, &o->budget);
+}
+
+// Juega una partida con la configuración en la silla seat y la base en las
+// demás; devuelve el margen de seat contra el mejor rival.
+static int play_game(sweep_t *sw, strategy_t **seats, game_state_t *gs, unsigned int game_seed, int seat, sim_player_t *sp) {
+    const sweep_opts_t *o = sw->o;
+    int pc = o->players;
+    sweep_game_t g = { .o = o, .seats = seats, .sp = sp };
+    game_local_hooks_t hooks = { .decide = sweep_decide, .ctx = &g };
+    game_play_local(gs, o->width, o->height, pc, game_seed, &hooks);
+    long best = 0;
+    bool any = false;
+    for (int q = 0; q < pc; q++) {
+        if (q == seat) continue;
+        if (!any || (long)gs->players[q].score > best) best = gs->players[q].score;
+        any = true;
+    }
+    return (int)((long)gs->players[seat].score - best);
+}
+
+static void *sweep_worker(void *arg) {
+    sweep_t *sw = arg;
+    const sweep_opts_t *o = sw->o;
+    int pc = o->players;
+    game_state_t *gs = malloc(game_state_size(o->width, o->height));
+    sim_player_t sp[MAX_PLAYERS];
+    if (!gs) {
+        sw->failed = 1;
+        return NULL;
+    }
+    int jobs = sw->config_count * o->seeds;
+    for (;;) {
+        int job = atomic_fetch_add(&sw->next_job, 1);
+        if (job >= jobs) break;
+        sweep_config_t *c = &sw->configs[job / o->seeds];
+        int seed = o->first_seed + job % o->seeds;
+
+        // Instancias nuevas en cada trabajo: el resultado no depende de qué
+        // hilo lo tome ni de cuántos haya.
+        double margin = 0.0, win = 0.0;
+        for (int rot = 0; rot < pc && !sw->failed; rot++) {
+            strategy_t *seats[MAX_PLAYERS] = {0};
+            for (int i = 0; i < pc; i++) {
+                seats[i] = strategy_create(o->width, o->height, pc, (unsigned int)(seed * 31 + rot * MAX_PLAYERS + i + 1));
+                if (!seats[i]) {
+                    sw->failed = 1;
+                    break;
+                }
+                strategy_set_params(seats[i], i == rot ? &c->params : &o->base);
+            }
+            if (!sw->failed) {
+                int m = play_game(sw, seats, gs, (unsigned int)seed, rot, sp);
+                margin += m;
+                win += m > 0 ? 1.0 : m == 0 ? 0.5 : 0.0;
+                sw->games++;
+            }
+            for (int i = 0; i < pc; i++) strategy_destroy(seats[i]);
+        }
+        sw->margins[job] = margin / pc;
+        sw->wins[job] = win / pc;
+    }
+    free(gs);
+    return NULL;
+}
+
+// Media y semiancho del intervalo del 95% (aproximación normal) de v[i] - ref[i]
+// (ref NULL: de v[i]).
+static void mean_ci(const double *v, const double *ref, int n, double *mean, double *half) {
+    double sum = 0.0, sq = 0.0;
+    for (int i = 0; i < n; i++) {
+        double x = v[i] - (ref ? ref[i] : 0.0);
+        sum += x;
+        sq += x * x;
+    }
+    *mean = n ? sum / n : 0.0;
+    double var = n > 1 ? (sq - sum * sum / n) / (n - 1) : 0.0;
+    *half = n > 1 && var > 0 ? SWEEP_Z95 * sqrt(var / n) : 0.0;
+}
+
+static int cmp_margin(const void *a, const void *b) {
+    const sweep_config_t *x = a, *y = b;
+    return (y->margin > x->margin) - (y->margin < x->margin);
+}
+
+static int add_config(sweep_config_t *configs, int *count, const strategy_params_t *p, bool is_base) {
+    if (*count == SWEEP_MAX_CONFIGS) {
+        fprintf(stderr, "Demasiadas configuraciones (máximo %d)\n", SWEEP_MAX_CONFIGS);
+        return -1;
+    }
+    sweep_config_t *c = &configs[*count];
+    memset(c, 0, sizeof(*c));
+    c->params = *p;
+    c->is_base = is_base;
+    strategy_params_format(p, c->name, sizeof(c->name));
+    // Repetidas (por ejemplo la base dentro de un eje) se juegan una vez.
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(configs[i].name, c->name) == 0) return 0;
+    }
+    (*count)++;
+    return 0;
+}
+
+// Producto cartesiano de los ejes "-a nombre=v1:v2:..." sobre la base.
+static int expand_axes(char **axes, int axis_count, int axis, strategy_params_t p, sweep_config_t *configs, int *count) {
+    if (axis == axis_count) return add_config(configs, count, &p, false);
+    const char *spec = axes[axis];
+    const char *eq = strchr(spec, '=');
+    if (!eq) return -1;
+    const char *v = eq + 1;
+    while (*v) {
+        size_t len = strcspn(v, ":");
+        char one[64];
+        if ((size_t)(eq - spec) + 1 + len >= sizeof(one)) return -1;
+        snprintf(one, sizeof(one), "%.*s=%.*s", (int)(eq - spec), spec, (int)len, v);
+        strategy_params_t q = p;
+        if (strategy_params_parse(one, &q) == -1) {
+            fprintf(stderr, "Valor inválido: %s\n", one);
+            return -1;
+        }
+        if (expand_axes(axes, axis_count, axis + 1, q, configs, count) == -1) return -1;
+        v += len;
+        if (*v == ':') v++;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    sweep_opts_t o = { .width = 10, .height = 10, .players = 2, .seeds = 50, .first_seed = 1, .threads = 0,
+                       .budget = { .max_sims = 200 }, .base = STRATEGY_PARAMS_DEFAULT };
+    static sweep_config_t configs[SWEEP_MAX_CONFIGS];
+    char *explicit[SWEEP_MAX_CONFIGS];
+    char *axes[SWEEP_MAX_AXES];
+    int explicit_count = 0, axis_count = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:g:s:j:S:b:c:a:")) != -1) {
+        switch (opt) {
+            case 'w': o.width = atoi(optarg); break;
+            case 'h': o.height = atoi(optarg); break;
+            case 'n': o.players = atoi(optarg); break;
+            case 'g': o.seeds = atoi(optarg); break;
+            case 's': o.first_seed = atoi(optarg); break;
+            case 'j': o.threads = atoi(optarg); break;
+            case 'S': o.budget.max_sims = atoi(optarg); break;
+            case 'b':
+                if (strategy_params_parse(optarg, &o.base) == -1) {
+                    fprintf(stderr, "Parámetros inválidos: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                if (explicit_count == SWEEP_MAX_CONFIGS) {
+                    fprintf(stderr, "Demasiadas configuraciones (máximo %d)\n", SWEEP_MAX_CONFIGS);
+                    return EXIT_FAILURE;
+                }
+                explicit[explicit_count++] = optarg;
+                break;
+            case 'a':
+                if (axis_count == SWEEP_MAX_AXES) {
+                    fprintf(stderr, "Demasiados ejes (máximo %d)\n", SWEEP_MAX_AXES);
+                    return EXIT_FAILURE;
+                }
+                axes[axis_count++] = optarg;
+                break;
+            default:
+                fprintf(stderr, "Uso: %s [-w ancho] [-h alto] [-n jugadores] [-g semillas] [-s primera_semilla] [-j hilos] [-S sims] [-b base] [-c config]... [-a nombre=v1:v2:...]...\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (o.width <= 0 || o.height <= 0 || o.players < 2 || o.players > MAX_PLAYERS || o.seeds <= 0 || o.budget.max_sims < 0) {
+        fprintf(stderr, "Parámetros inválidos\n");
+        return EXIT_FAILURE;
+    }
+    // Se barre la heurística de Monte Carlo tal cual, sin lo que pueda venir por entorno.
+    unsetenv("CHOMP_ENGINE");
+    unsetenv("CHOMP_EVAL");
+    unsetenv("CHOMP_BOOK");
+    unsetenv("CHOMP_PARAMS");
+
+    int config_count = 0;
+    if (add_config(configs, &config_count, &o.base, true) == -1) return EXIT_FAILURE;
+    for (int i = 0; i < explicit_count; i++) {
+        strategy_params_t p = o.base;
+        if (strategy_params_parse(explicit[i], &p) == -1) {
+            fprintf(stderr, "Parámetros inválidos: %s\n", explicit[i]);
+            return EXIT_FAILURE;
+        }
+        if (add_config(configs, &config_count, &p, false) == -1) return EXIT_FAILURE;
+    }
+    if (axis_count && expand_axes(axes, axis_count, 0, o.base, configs, &config_count) == -1) {
+        fprintf(stderr, "Eje inválido\n");
+        return EXIT_FAILURE;
+    }
+
+    sweep_t sw = { .o = &o, .configs = configs, .config_count = config_count,
+                   .margins = calloc((size_t)config_count * o.seeds, sizeof(double)),
+                   .wins = calloc((size_t)config_count * o.seeds, sizeof(double)) };
+    int threads = o.threads;
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+    if (threads > config_count * o.seeds) threads = config_count * o.seeds;
+    pthread_t *tids = calloc(threads, sizeof(pthread_t));
+    if (!tids || !sw.margins || !sw.wins) {
+        perror("calloc");
+        free(tids);
+        free(sw.margins);
+        free(sw.wins);
+        return EXIT_FAILURE;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&tids[t], NULL, sweep_worker, &sw) != 0) {
+            perror("pthread_create");
+            break;
+        }
+        started++;
+    }
+    // Si no arrancó ninguno, el principal hace el trabajo.
+    if (started == 0) sweep_worker(&sw);
+    for (int t = 0; t < started; t++) pthread_join(tids[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    free(tids);
+    if (sw.failed) {
+        fprintf(stderr, "sweep: sin memoria para las estrategias\n");
+        free(sw.margins);
+        free(sw.wins);
+        return EXIT_FAILURE;
+    }
+    // La base es siempre la configuración 0.
+    for (int i = 0; i < config_count; i++) {
+        sweep_config_t *c = &configs[i];
+        const double *m = sw.margins + (size_t)i * o.seeds;
+        mean_ci(m, NULL, o.seeds, &c->margin, &c->margin_ci);
+        mean_ci(sw.wins + (size_t)i * o.seeds, NULL, o.seeds, &c->win, &c->win_ci);
+        mean_ci(m, sw.margins, o.seeds, &c->delta, &c->delta_ci);
+    }
+    free(sw.margins);
+    free(sw.wins);
+
+    qsort(configs, config_count, sizeof(sweep_config_t), cmp_margin);
+    printf("%d configuraciones x %d semillas, %lu partidas %dx%d con %d jugadores en %.1f s (%.1f partidas/s, %d hilos)\n",
+           config_count, o.seeds, (unsigned long)sw.games, o.width, o.height, o.players, secs,
+           secs > 0 ? sw.games / secs : 0.0, started ? started : 1);
+    printf("%3s  %-17s  %-17s  %-16s  %s\n", "#", "margen ± IC95", "vs. base ± IC95", "victorias ± IC95", "configuración");
+    for (int i = 0; i < config_count; i++) {
+        const sweep_config_t *c = &configs[i];
+        char win[32];
+        snprintf(win, sizeof(win), "%.1f%% ± %.1f", 100.0 * c->win, 100.0 * c->win_ci);
+        printf("%3d  %+7.2f ± %-6.2f  %+7.2f ± %-6.2f  %-16s  %s%s\n", i + 1, c->margin, c->margin_ci, c->delta,
+               c->delta_ci, win, c->name, c->is_base ? "  (base)" : "");
+    }
+    return EXIT_SUCCESS;
+}
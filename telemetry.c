@@ -0,0 +1,59 @@
+#include "telemetry.h"
+#include "shm_manager.h"
+#include "metrics.h"
+
+telemetry_t *telemetry = NULL;
+
+static shm_manager_t *telemetry_mgr = NULL;
+
+int telemetry_create(unsigned int player_count) {
+    telemetry_mgr = shm_manager_create(SHM_GAME_TELEMETRY, sizeof(telemetry_t), 0644, 0, 0);
+    if (!telemetry_mgr) {
+        perror("shm_manager_create telemetry");
+        return -1;
+    }
+    telemetry = shm_manager_data(telemetry_mgr);
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->magic = TELEMETRY_MAGIC;
+    telemetry->version = TELEMETRY_VERSION;
+    telemetry->size = sizeof(telemetry_t);
+    atomic_store(&telemetry->player_count, player_count);
+    atomic_store(&telemetry->master_pid, getpid());
+    atomic_store(&telemetry->start_ns, metrics_now_ns());
+    return 0;
+}
+
+int telemetry_attach(void) {
+    telemetry_mgr = shm_manager_open(SHM_GAME_TELEMETRY, sizeof(telemetry_t), 0);
+    if (!telemetry_mgr) return -1;
+    telemetry_t *t = shm_manager_data(telemetry_mgr);
+    if (t->magic != TELEMETRY_MAGIC || t->version != TELEMETRY_VERSION || t->size != sizeof(telemetry_t)) {
+        shm_manager_close(telemetry_mgr);
+        telemetry_mgr = NULL;
+        return -1;
+    }
+    telemetry = t;
+    return 0;
+}
+
+void telemetry_close(void) {
+    if (telemetry_mgr) shm_manager_close(telemetry_mgr);
+    telemetry_mgr = NULL;
+    telemetry = NULL;
+}
+
+void telemetry_destroy(void) {
+    if (telemetry_mgr) shm_manager_destroy(telemetry_mgr);
+    telemetry_mgr = NULL;
+    telemetry = NULL;
+}
+
+uint64_t telemetry_rss_kb(void) {
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+    if (n != 2) return 0;
+    return (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE) / 1024u;
+}
@@ -0,0 +1,60 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "common.h"
+
+// Contadores en vivo publicados en /game_telemetry. Cada campo tiene un único
+// escritor (el master o el jugador dueño del registro); chompstat lo lee en
+// modo sólo lectura. Cambiar el layout implica subir TELEMETRY_VERSION.
+#define SHM_GAME_TELEMETRY "/game_telemetry"
+#define TELEMETRY_MAGIC 0x43485453u
+#define TELEMETRY_VERSION 2
+
+typedef struct {
+    _Atomic pid_t pid;
+    _Atomic uint64_t decisions;
+    _Atomic uint64_t think_ns_total;
+    _Atomic uint64_t think_ns_last;
+    _Atomic uint64_t sims_total;
+    _Atomic uint64_t sims_per_sec;
+    _Atomic uint32_t depth_avg;
+    _Atomic uint32_t depth_max;
+    _Atomic uint64_t lock_wait_ns;
+    _Atomic uint64_t rss_kb;
+    _Atomic uint64_t updated_ns;
+    // Espera de turno (turnwait.h): tokens recibidos, tiempo hasta despertar
+    // y, con CHOMP_SPIN_US, cuántas veces el token llegó durante el spin.
+    _Atomic uint64_t tokens;
+    _Atomic uint64_t wake_ns_total;
+    _Atomic uint64_t spin_hits;
+    _Atomic uint64_t spin_misses;
+} telemetry_player_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    _Atomic uint32_t player_count;
+    _Atomic pid_t master_pid;
+    _Atomic uint64_t start_ns;
+    _Atomic uint64_t moves_valid;
+    _Atomic uint64_t moves_invalid;
+    _Atomic uint64_t lock_wait_ns;
+    _Atomic uint64_t rss_kb;
+    _Atomic uint64_t updated_ns;
+    _Atomic uint32_t game_over;
+    telemetry_player_t players[MAX_PLAYERS];
+} telemetry_t;
+
+extern telemetry_t *telemetry;
+
+int telemetry_create(unsigned int player_count);
+int telemetry_attach(void);
+void telemetry_close(void);
+void telemetry_destroy(void);
+
+uint64_t telemetry_rss_kb(void);
+
+#endif
@@ -0,0 +1,80 @@
+#include "trace.h"
+#include "shm_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+trace_slot_t *trace_self = NULL;
+
+static shm_manager_t *trace_mgr = NULL;
+
+const char *const trace_event_names[TR_EVENT_COUNT] = {
+    "token_wait",
+    "snapshot",
+    "search",
+    "write",
+    "select",
+    "validate",
+    "view_handshake",
+    "sleep",
+    "draw",
+    "move"
+};
+
+bool trace_requested(void) {
+    const char *v = getenv("CHOMP_TRACE");
+    return v != NULL && *v != '\0' && strcmp(v, "0") != 0;
+}
+
+int trace_create(void) {
+    if (!trace_requested()) return 0;
+    trace_mgr = shm_manager_create(SHM_GAME_TRACE, sizeof(trace_buffer_t), 0666, 0, 0);
+    if (!trace_mgr) {
+        perror("shm_manager_create trace");
+        return -1;
+    }
+    trace_buffer_t *buf = shm_manager_data(trace_mgr);
+    buf->magic = TRACE_MAGIC;
+    buf->version = TRACE_VERSION;
+    buf->slot_count = TRACE_MAX_SLOTS;
+    buf->events_per_slot = TRACE_EVENTS_PER_SLOT;
+    atomic_store(&buf->next_slot, 0);
+    for (int i = 0; i < TRACE_MAX_SLOTS; i++) {
+        buf->slots[i].pid = 0;
+        buf->slots[i].role[0] = '\0';
+        atomic_store(&buf->slots[i].head, 0);
+    }
+    // El segmento queda vivo al salir para que trace_dump pueda leerlo.
+    shm_manager_close(trace_mgr);
+    trace_mgr = NULL;
+    return 0;
+}
+
+void trace_attach(const char *role) {
+    if (trace_self || !trace_requested()) return;
+    trace_mgr = shm_manager_open(SHM_GAME_TRACE, sizeof(trace_buffer_t), 0);
+    if (!trace_mgr) return;
+    trace_buffer_t *buf = shm_manager_data(trace_mgr);
+    if (buf->magic != TRACE_MAGIC || buf->version != TRACE_VERSION) {
+        trace_detach();
+        return;
+    }
+    uint32_t slot = atomic_fetch_add(&buf->next_slot, 1);
+    if (slot >= TRACE_MAX_SLOTS) {
+        trace_detach();
+        return;
+    }
+    trace_slot_t *s = &buf->slots[slot];
+    s->pid = getpid();
+    snprintf(s->role, sizeof(s->role), "%s", role);
+    trace_self = s;
+}
+
+void trace_detach(void) {
+    trace_self = NULL;
+    if (trace_mgr) {
+        shm_manager_close(trace_mgr);
+        trace_mgr = NULL;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/types.h>
+
+// Trazado por jugada. Compilado siempre, pero inactivo salvo que CHOMP_TRACE
+// esté definida: el master crea /game_trace y cada proceso toma un slot con
+// su propio buffer circular (un único escritor, sin locks). trace_dump lo
+// exporta como JSON de Chrome trace / Perfetto.
+#define SHM_GAME_TRACE "/game_trace"
+#define TRACE_MAGIC 0x43485452u
+#define TRACE_VERSION 1
+#define TRACE_MAX_SLOTS 16
+#define TRACE_EVENTS_PER_SLOT (1u << 14)
+
+typedef enum {
+    TR_TOKEN_WAIT = 0,
+    TR_SNAPSHOT,
+    TR_SEARCH,
+    TR_WRITE,
+    TR_SELECT,
+    TR_VALIDATE,
+    TR_VIEW_HANDSHAKE,
+    TR_SLEEP,
+    TR_DRAW,
+    TR_MOVE,
+    TR_EVENT_COUNT
+} trace_event_id_t;
+
+enum { TRACE_PH_BEGIN = 'B', TRACE_PH_END = 'E', TRACE_PH_INSTANT = 'i' };
+
+typedef struct {
+    uint64_t ts_ns;
+    uint16_t id;
+    uint8_t phase;
+    uint8_t reserved;
+    int32_t arg;
+} trace_event_t;
+
+typedef struct {
+    pid_t pid;
+    char role[16];
+    _Atomic uint64_t head;
+    trace_event_t events[TRACE_EVENTS_PER_SLOT];
+} trace_slot_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t events_per_slot;
+    _Atomic uint32_t next_slot;
+    trace_slot_t slots[TRACE_MAX_SLOTS];
+} trace_buffer_t;
+
+extern trace_slot_t *trace_self;
+
+extern const char *const trace_event_names[TR_EVENT_COUNT];
+
+bool trace_requested(void);
+int trace_create(void);
+void trace_attach(const char *role);
+void trace_detach(void);
+
+static inline void trace_emit(trace_event_id_t id, int phase, int32_t arg) {
+    trace_slot_t *s = trace_self;
+    if (!s) return;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t h = atomic_load_explicit(&s->head, memory_order_relaxed);
+    trace_event_t *e = &s->events[h & (TRACE_EVENTS_PER_SLOT - 1)];
+    e->ts_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    e->id = (uint16_t)id;
+    e->phase = (uint8_t)phase;
+    e->arg = arg;
+    atomic_store_explicit(&s->head, h + 1, memory_order_release);
+}
+
+static inline void trace_begin(trace_event_id_t id) { trace_emit(id, TRACE_PH_BEGIN, 0); }
+static inline void trace_end(trace_event_id_t id, int32_t arg) { trace_emit(id, TRACE_PH_END, arg); }
+static inline void trace_instant(trace_event_id_t id, int32_t arg) { trace_emit(id, TRACE_PH_INSTANT, arg); }
+
+#endif
@@ -0,0 +1,88 @@
+#include "trace.h"
+#include "shm_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/mman.h>
+
+static uint64_t slot_first(uint64_t head) {
+    return head > TRACE_EVENTS_PER_SLOT ? head - TRACE_EVENTS_PER_SLOT : 0;
+}
+
+int main(int argc, char *argv[]) {
+    bool unlink_after = false;
+    const char *out_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "uo:")) != -1) {
+        switch (opt) {
+            case 'u': unlink_after = true; break;
+            case 'o': out_path = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-o salida.json] [-u]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    shm_manager_t *mgr = shm_manager_open(SHM_GAME_TRACE, sizeof(trace_buffer_t), 0);
+    if (!mgr) {
+        perror("shm_manager_open trace (¿se corrió el master con CHOMP_TRACE=1?)");
+        return EXIT_FAILURE;
+    }
+    const trace_buffer_t *buf = shm_manager_data(mgr);
+    if (buf->magic != TRACE_MAGIC || buf->version != TRACE_VERSION) {
+        fprintf(stderr, "trace_dump: segmento %s con formato desconocido\n", SHM_GAME_TRACE);
+        shm_manager_close(mgr);
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = stdout;
+    if (out_path && (out = fopen(out_path, "w")) == NULL) {
+        perror(out_path);
+        shm_manager_close(mgr);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t slots = atomic_load(&((trace_buffer_t *)buf)->next_slot);
+    if (slots > TRACE_MAX_SLOTS) slots = TRACE_MAX_SLOTS;
+
+    uint64_t t0 = UINT64_MAX;
+    for (uint32_t i = 0; i < slots; i++) {
+        const trace_slot_t *s = &buf->slots[i];
+        uint64_t head = atomic_load((_Atomic uint64_t *)&s->head);
+        if (head > slot_first(head)) {
+            uint64_t ts = s->events[slot_first(head) & (TRACE_EVENTS_PER_SLOT - 1)].ts_ns;
+            if (ts < t0) t0 = ts;
+        }
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    unsigned long total = 0;
+    for (uint32_t i = 0; i < slots; i++) {
+        const trace_slot_t *s = &buf->slots[i];
+        fprintf(out, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                first ? "" : ",\n", (int)s->pid, s->role, (int)s->pid);
+        first = false;
+        uint64_t head = atomic_load((_Atomic uint64_t *)&s->head);
+        for (uint64_t h = slot_first(head); h < head; h++) {
+            const trace_event_t *e = &s->events[h & (TRACE_EVENTS_PER_SLOT - 1)];
+            if (e->id >= TR_EVENT_COUNT) continue;
+            double ts_us = (double)(e->ts_ns - t0) / 1000.0;
+            fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d",
+                    trace_event_names[e->id], e->phase, ts_us, (int)s->pid, (int)s->pid);
+            if (e->phase == TRACE_PH_INSTANT) fprintf(out, ",\"s\":\"p\"");
+            if (e->phase != TRACE_PH_BEGIN) fprintf(out, ",\"args\":{\"arg\":%d}", (int)e->arg);
+            fputc('}', out);
+            total++;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "trace_dump: %lu eventos de %u procesos\n", total, slots);
+    shm_manager_close(mgr);
+    if (unlink_after) shm_unlink(SHM_GAME_TRACE);
+    return EXIT_SUCCESS;
+}
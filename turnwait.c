@@ -0,0 +1,63 @@
+#include "turnwait.h"
+#include "metrics.h"
+
+void turn_spin_init(turn_spin_t *ts, game_sync_t *sync, int i, unsigned int budget_us) {
+    memset(ts, 0, sizeof(*ts));
+    if (budget_us == 0) return;
+    ts->enabled = true;
+    ts->seen = atomic_load_explicit(&sync->turn_seq[i], memory_order_acquire);
+
+    // Un pause cuesta de ~10 a ~150 ciclos según la microarquitectura: se mide.
+    const uint32_t probe = 20000;
+    uint64_t t0 = metrics_now_ns();
+    for (uint32_t k = 0; k < probe; k++) cpu_relax();
+    uint64_t dt = metrics_now_ns() - t0;
+    if (dt == 0) dt = 1;
+    uint64_t iters = (uint64_t)budget_us * 1000ull * probe / dt;
+    if (iters < 16) iters = 16;
+    if (iters > UINT32_MAX) iters = UINT32_MAX;
+    ts->max_iters = (uint32_t)iters;
+    ts->min_iters = ts->max_iters / 64 > 16 ? ts->max_iters / 64 : 16;
+    ts->budget_iters = ts->max_iters;
+}
+
+static void turn_woke(turn_spin_t *ts, game_sync_t *sync, int i, uint64_t t0) {
+    uint64_t now = metrics_now_ns();
+    uint64_t released = atomic_load_explicit(&sync->turn_release_ns[i], memory_order_relaxed);
+    uint64_t from = released > t0 ? released : t0;
+    ts->wake_ns_last = now > from ? now - from : 0;
+    ts->wake_ns_total += ts->wake_ns_last;
+    ts->tokens++;
+    if (ts->enabled) ts->seen = atomic_load_explicit(&sync->turn_seq[i], memory_order_acquire);
+}
+
+int turn_wait(turn_spin_t *ts, game_sync_t *sync, int i) {
+    uint64_t t0 = metrics_now_ns();
+    // Un token que el propio jugador devolvió (EINTR, pool de chompd) no mueve
+    // turn_seq: si ya está en el semáforo no hay que espinar por él.
+    if (sem_trywait(&sync->player_mutex[i]) == 0) {
+        turn_woke(ts, sync, i, t0);
+        return 0;
+    }
+    if (ts->enabled) {
+        uint32_t k = 0;
+        while (k < ts->budget_iters &&
+               atomic_load_explicit(&sync->turn_seq[i], memory_order_acquire) == ts->seen) {
+            cpu_relax();
+            k++;
+        }
+        // Si el rival suele tardar más que el presupuesto, se espina menos la próxima vez.
+        if (k < ts->budget_iters) {
+            ts->spin_hits++;
+            if (ts->budget_iters < ts->max_iters) ts->budget_iters *= 2;
+            if (ts->budget_iters > ts->max_iters) ts->budget_iters = ts->max_iters;
+        } else {
+            ts->spin_misses++;
+            ts->budget_iters /= 2;
+            if (ts->budget_iters < ts->min_iters) ts->budget_iters = ts->min_iters;
+        }
+    }
+    int rc = sem_wait(&sync->player_mutex[i]);
+    if (rc == 0) turn_woke(ts, sync, i, t0);
+    return rc;
+}
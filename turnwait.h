@@ -0,0 +1,50 @@
+#ifndef TURNWAIT_H
+#define TURNWAIT_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "common.h"
+#include "metrics.h"
+
+// Espera de turno "spin y después bloqueo" (opcional, CHOMP_SPIN_US). El master
+// incrementa turn_seq[i] antes de cada sem_post del token; el jugador espina
+// con pause mirando ese contador y recién cuando se agota el presupuesto cae
+// en sem_wait. El semáforo sigue siendo la fuente de verdad: el spin sólo evita
+// dormir en el futex cuando el token está por llegar.
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static inline void turn_release(game_sync_t *sync, int i) {
+    atomic_store_explicit(&sync->turn_release_ns[i], metrics_now_ns(), memory_order_relaxed);
+    atomic_fetch_add_explicit(&sync->turn_seq[i], 1, memory_order_release);
+    sem_post(&sync->player_mutex[i]);
+}
+
+typedef struct {
+    bool enabled;
+    unsigned int seen;
+    uint32_t budget_iters;  // adaptativo entre min_iters y max_iters
+    uint32_t min_iters;
+    uint32_t max_iters;
+    uint64_t spin_hits;     // el token llegó mientras espinaba
+    uint64_t spin_misses;   // se agotó el presupuesto y bloqueó
+    // Desde la entrega del token (o desde que se empezó a esperar, si ya
+    // estaba) hasta que turn_wait vuelve; se mide con o sin spin.
+    uint64_t tokens;
+    uint64_t wake_ns_total;
+    uint64_t wake_ns_last;
+} turn_spin_t;
+
+// Calibra cuántas iteraciones de pause entran en budget_us. budget_us == 0 lo deshabilita.
+void turn_spin_init(turn_spin_t *ts, game_sync_t *sync, int i, unsigned int budget_us);
+
+// Igual que sem_wait(&sync->player_mutex[i]): 0 o -1 con errno.
+int turn_wait(turn_spin_t *ts, game_sync_t *sync, int i);
+
+#endif
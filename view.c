@@ -1,6 +1,7 @@
 
 #include "common.h"
 #include "shm_manager.h"
+#include "trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -41,6 +42,8 @@ int main(int argc, char *argv[]) {
     if (!sync_mgr) { perror("shm_manager_open sync"); shm_manager_close(state_mgr); exit(EXIT_FAILURE); }
     game_sync_t *game_sync = (game_sync_t *)shm_manager_data(sync_mgr);
 
+    trace_attach("view");
+
     const char *bg_colors[] = {
         "\x1b[41m", "\x1b[42m", "\x1b[43m", "\x1b[44m",
         "\x1b[45m", "\x1b[46m", "\x1b[101m", "\x1b[102m", "\x1b[103m"
@@ -53,6 +56,7 @@ int main(int argc, char *argv[]) {
 
     while (!game_state->game_over) {
         sem_wait(&game_sync->master_to_view);
+        trace_begin(TR_DRAW);
 
         printf("\033[2J\033[H");
 
@@ -103,11 +107,13 @@ int main(int argc, char *argv[]) {
         }
         if (order) free(order);
 
+        trace_end(TR_DRAW, 0);
         sem_post(&game_sync->view_to_master);
 
         if (game_state->game_over) break;
     }
 
+    trace_detach();
     shm_manager_close(state_mgr);
     shm_manager_close(sync_mgr);
 